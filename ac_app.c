@@ -2,179 +2,368 @@
 #include <furi_hal_infrared.h>
 #include <gui/gui.h>
 #include <input/input.h>
-#include "infrared_signal.h"
+#include <notification/notification_messages.h>
+#include <storage/storage.h>
+#include "ac_device.h"
+#include "ac_scheduler.h"
+#include "ac_stats.h"
+#include "ac_trace.h"
+#include "ac_tx_worker.h"
 
 // Timing constants.
-static const uint32_t one_second_interval = 1000; // 1 second in milliseconds
 static const uint32_t one_minute_interval = 60000; // 1 minute in milliseconds
 static const uint32_t one_hour_interval = 3600000; // 1 hour in milliseconds
 static const uint32_t three_hour_interval = 10800000; // 3 hours in milliseconds
 
+#define AC_APP_MAX_DEVICES 6 // As many as fit on-screen, one per line
+
+// Events handled by the main loop.
+typedef enum {
+    AcAppEventTypeInput,
+    AcAppEventTypeLoaded, // The loader thread is done, whether the remotes loaded or not.
+    AcAppEventTypeWake, // A key was pressed while headless.
+} AcAppEventType;
+
+typedef struct {
+    AcAppEventType type;
+    InputEvent input;
+} AcAppEvent;
+
+// What the loader thread needs from the main one.
+typedef struct {
+    ViewPort* view_port;
+    FuriMessageQueue* event_queue;
+} AcAppLoaderContext;
+
 // Global variables.
+static const char* loading_text = "Loading remote...";
 static const char* ac_on_text = "The A/C should be on.";
 static const char* ac_off_text = "The A/C should be off.";
-static bool ac_is_on = false;
-static uint32_t next_signal_interval = one_hour_interval;
-static uint32_t remaining_time = one_hour_interval; // Initial remaining time in milliseconds
+static const char* no_remote_text = "Could not load Ac.ir.";
+static bool loading = true; // Cleared by the main thread once the devices are loaded and started
+static bool showing_stats = false; // Send timing shown instead of the countdown, toggled with OK
+static bool redraw_pending = false; // Coalesces redraw requests into one per loop iteration
+
+// Headless, nothing is drawn and the backlight is off; only the units keep running, the
+// countdown isn't refreshed. Any key brings the screen back. The ViewPort stays enabled
+// all along, so that keys keep coming here instead of going to the desktop under it.
+static volatile bool headless = false; // Also read by the input callback
+static InputKey wake_key = InputKeyMAX; // Ignored until released, only used by the input callback
+
+// On-screen text, rebuilt on the app thread only when what it shows changes, so the
+// render callback just draws it. The mutex keeps a half-written line off the screen.
+static FuriMutex* text_mutex = NULL;
+static bool text_valid = false;
+static uint32_t displayed_minutes[AC_APP_MAX_DEVICES]; // Countdown values put in the text
+static bool displayed_on[AC_APP_MAX_DEVICES];
+static char countdown_text[32]; // With a single unit
+static char device_lines[AC_APP_MAX_DEVICES][48]; // With several units, one line each
+
+// Units to be cycled, from the devices file. Without one, a single unit uses the first
+// remote file that loads, in order of preference. A remote saved with the Infrared app
+// replaces the one shipped with this app, so other units work without recompiling.
+static const char* devices_path = EXT_PATH("infrared/Ac.devices");
+static const char* trace_path = APP_DATA_PATH("ac.trace"); // Saved on exit, see ac_trace.h
+static const char* state_path = APP_DATA_PATH("ac.state"); // Saved whenever a unit switches
+static const char* const remote_paths[] = {
+    EXT_PATH("infrared/Ac.ir"),
+    APP_ASSETS_PATH("Ac.ir"),
+};
+
+static AcDevice* devices[AC_APP_MAX_DEVICES];
+static AcDeviceState saved_states[AC_APP_MAX_DEVICES]; // Read by the loader thread
+static bool has_saved_state[AC_APP_MAX_DEVICES];
+static size_t devices_count = 0; // Loaded devices only
+static AcTxWorker* tx_worker = NULL;
+
+// Everything timed runs from the main loop, off this scheduler.
+static AcScheduler* scheduler = NULL;
+static AcSchedulerId countdown_event = AC_SCHEDULER_ID_NONE;
+
+// Function to format the countdown of a device, in whole minutes.
+static void format_countdown(char* text, size_t size, uint32_t remaining_minutes) {
+    if(remaining_minutes == 0) {
+        snprintf(text, size, "Sending signal soon...");
+    } else if(remaining_minutes == 1) {
+        snprintf(text, size, "Next signal in 1 min.");
+    } else {
+        snprintf(text, size, "Next signal in %lu mins.", remaining_minutes);
+    }
+}
 
-// Infrared signals to be used.
-static const uint32_t ir_address_1 = 0x00006F98; // The A/C itself
-static const uint32_t ir_command_1 = 0x0000E619; // Power button
-static const uint32_t ir_command_2 = 0x0000F708; // Mode button
+// Function to draw the send timing statistics, one histogram per line.
+static void render_stats(Canvas* canvas) {
+    canvas_draw_str(canvas, 2, 10, "Send timing (ms)");
 
-// Turn-on sequence state machine.
-typedef enum {
-    AcSequenceIdle,
-    AcSequenceTurnOnStep1, // Power sent, waiting to send first Mode
-    AcSequenceTurnOnStep2, // First Mode sent, waiting to send second Mode
-} AcSequenceState;
+    canvas_set_font(canvas, FontSecondary);
+    canvas_draw_str(canvas, 2, 20, "avg/p95/max, count");
+    for(size_t id = 0; id < AcStatsIdMAX; ++id) {
+        const AcHistogram* histogram = ac_stats_get(id);
+        char line[48];
+        snprintf(
+            line,
+            sizeof(line),
+            "%s: %lu/%lu/%lu, %lu",
+            ac_stats_get_name(id),
+            ac_histogram_get_mean(histogram),
+            ac_histogram_get_percentile(histogram, 95),
+            histogram->max,
+            histogram->count);
+        canvas_draw_str(canvas, 2, 30 + id * 10, line);
+    }
+}
+
+// Function to rebuild the on-screen text if any of its values changed.
+// Calculates the remaining minutes from the deadlines, so the countdown never drifts.
+static bool update_text(void) {
+    bool changed = !text_valid;
+    uint32_t minutes[AC_APP_MAX_DEVICES];
+    for(size_t i = 0; i < devices_count; ++i) {
+        minutes[i] = ac_device_get_remaining_time(devices[i]) / one_minute_interval;
+        changed |= minutes[i] != displayed_minutes[i] ||
+                   ac_device_is_on(devices[i]) != displayed_on[i];
+    }
+    if(!changed) return false;
+
+    furi_mutex_acquire(text_mutex, FuriWaitForever);
+    for(size_t i = 0; i < devices_count; ++i) {
+        displayed_minutes[i] = minutes[i];
+        displayed_on[i] = ac_device_is_on(devices[i]);
+        snprintf(
+            device_lines[i],
+            sizeof(device_lines[i]),
+            "%s: %s, %lu min",
+            ac_device_get_name(devices[i]),
+            displayed_on[i] ? "on" : "off",
+            displayed_minutes[i]);
+    }
+    if(devices_count > 0) {
+        format_countdown(countdown_text, sizeof(countdown_text), displayed_minutes[0]);
+    }
+    text_valid = true;
+    furi_mutex_release(text_mutex);
 
-static AcSequenceState sequence_state = AcSequenceIdle;
+    return true;
+}
 
-// Timers. Putting them here to avoid NULL pointer dereferences.
-static FuriTimer* signal_timer = NULL;
-static FuriTimer* countdown_timer = NULL;
-static FuriTimer* sequence_timer = NULL;
+// Function to ask for a redraw, done once the current loop iteration is over.
+static void request_redraw(void) {
+    redraw_pending = true;
+}
 
-// Function to handle GUI events.
+// Function to handle GUI events. The GUI clears the canvas before calling it.
 static void ac_app_render_callback(Canvas* canvas, void* ctx) {
     UNUSED(ctx);
-    canvas_clear(canvas);
+    if(headless) return;
+
     canvas_set_font(canvas, FontPrimary);
 
-    // Display the appropriate text.
-    canvas_draw_str_aligned(
-        canvas, 64, 32, AlignCenter, AlignCenter, ac_is_on ? ac_on_text : ac_off_text);
+    if(showing_stats) {
+        render_stats(canvas);
+        return;
+    }
 
-    // Calculate the remaining minutes.
-    uint32_t remaining_minutes = remaining_time / one_minute_interval;
-    char countdown_text[32];
-    if(remaining_minutes == 0) {
-        snprintf(countdown_text, sizeof(countdown_text), "Sending signal soon...");
-    } else if(remaining_minutes == 1) {
-        snprintf(countdown_text, sizeof(countdown_text), "Next signal in 1 min.");
-    } else {
-        snprintf(
-            countdown_text, sizeof(countdown_text), "Next signal in %lu mins.", remaining_minutes);
+    if(loading || !text_valid) {
+        canvas_draw_str_aligned(canvas, 64, 32, AlignCenter, AlignCenter, loading_text);
+        return;
+    }
+
+    if(devices_count == 0) {
+        canvas_draw_str_aligned(canvas, 64, 32, AlignCenter, AlignCenter, no_remote_text);
+        return;
     }
 
-    // Display the countdown text on-screen.
-    canvas_draw_str_aligned(canvas, 64, 48, AlignCenter, AlignCenter, countdown_text);
+    furi_mutex_acquire(text_mutex, FuriWaitForever);
+    if(devices_count == 1) {
+        // Display the appropriate text.
+        canvas_draw_str_aligned(
+            canvas, 64, 32, AlignCenter, AlignCenter, displayed_on[0] ? ac_on_text : ac_off_text);
+
+        // Display the countdown text on-screen.
+        canvas_draw_str_aligned(canvas, 64, 48, AlignCenter, AlignCenter, countdown_text);
+    } else {
+        // One line per unit: name, state and minutes until it switches.
+        canvas_set_font(canvas, FontSecondary);
+        for(size_t i = 0; i < devices_count; ++i) {
+            canvas_draw_str(canvas, 2, 10 + i * 10, device_lines[i]);
+        }
+    }
+    furi_mutex_release(text_mutex);
 }
 
-// Function to send the infrared signal.
-static void send_ir_signal(uint32_t address, uint32_t command) {
-    InfraredSignal* signal = infrared_signal_alloc();
-    InfraredMessage message = {
-        .protocol = InfraredProtocolNECext,
-        .address = address,
-        .command = command,
-    };
-    infrared_signal_set_message(signal, &message);
-    infrared_signal_transmit(signal);
-    infrared_signal_free(signal);
-    FURI_LOG_I(
-        "ir_tx",
-        "Sent infrared signal: address=0x%08lX, command=0x%08lX",
-        address,
-        command);
+static void update_countdown(void* ctx);
+
+// Function to schedule a countdown refresh for the moment a displayed minute value changes.
+static void schedule_countdown_update(ViewPort* view_port) {
+    uint32_t wait = UINT32_MAX;
+    for(size_t i = 0; i < devices_count && !headless; ++i) {
+        uint32_t remaining = ac_device_get_remaining_time(devices[i]);
+        if(remaining > 0) {
+            wait = MIN(wait, remaining % one_minute_interval + 1);
+        }
+    }
+
+    ac_scheduler_cancel(scheduler, countdown_event);
+    countdown_event = AC_SCHEDULER_ID_NONE;
+    if(wait != UINT32_MAX) {
+        countdown_event =
+            ac_scheduler_add(scheduler, furi_get_tick() + wait, update_countdown, view_port);
+    }
 }
 
-// Sequence timer callback to complete the turn-on steps without blocking.
-static void sequence_step_callback(void* ctx) {
+// Scheduler callback to refresh the countdown, due only when a minute value changes.
+static void update_countdown(void* ctx) {
     ViewPort* view_port = (ViewPort*)ctx;
+    countdown_event = AC_SCHEDULER_ID_NONE;
 
-    if(sequence_state == AcSequenceTurnOnStep1) {
-        send_ir_signal(ir_address_1, ir_command_2);
-        sequence_state = AcSequenceTurnOnStep2;
-        furi_timer_start(sequence_timer, one_second_interval);
-    } else if(sequence_state == AcSequenceTurnOnStep2) {
-        send_ir_signal(ir_address_1, ir_command_2);
-        sequence_state = AcSequenceIdle;
-        ac_is_on = true;
-        next_signal_interval = one_hour_interval;
-        remaining_time = next_signal_interval;
-
-        // Schedule the next signal.
-        furi_timer_stop(signal_timer);
-        furi_timer_start(signal_timer, next_signal_interval);
-
-        view_port_update(view_port);
-        FURI_LOG_I("ac_app", "The A/C should be on.");
+    if(update_text()) {
+        ac_trace_record(AcTraceEventCountdownRefresh, 0, 0);
+        request_redraw();
     }
+
+    // Wait for the next minute boundary relative to the deadlines.
+    schedule_countdown_update(view_port);
 }
 
-// Function to actually send signals and update text based on the current state.
-static void send_signals_and_update_text(void* ctx) {
+// Device callback, invoked whenever a unit starts a sequence or switches state.
+static void device_changed_callback(AcDevice* device, void* ctx) {
     ViewPort* view_port = (ViewPort*)ctx;
 
-    if(ac_is_on) {
-        // Send signal to turn off the A/C and update the text.
-        send_ir_signal(ir_address_1, ir_command_1);
-        ac_is_on = false;
-        next_signal_interval = three_hour_interval;
-        remaining_time = next_signal_interval;
+    UNUSED(device);
+    // Everything is refreshed at once when loading is done.
+    if(loading) return;
 
-        // Schedule the next signal based on the current state.
-        furi_timer_stop(signal_timer);
-        furi_timer_start(signal_timer, next_signal_interval);
+    // Checkpoint the states, down to the steps of a switch, so a restart resumes from here.
+    ac_device_state_save(state_path, devices, devices_count);
 
-        view_port_update(view_port);
-        FURI_LOG_I("ac_app", "The A/C should be off.");
-    } else {
-        // Start the turn-on sequence: send Power, then Mode twice with delays.
-        send_ir_signal(ir_address_1, ir_command_1);
-        sequence_state = AcSequenceTurnOnStep1;
-        furi_timer_start(sequence_timer, one_second_interval);
+    // The countdown follows whatever gets scheduled.
+    schedule_countdown_update(view_port);
+    if(update_text()) {
+        request_redraw();
+    }
+}
 
-        // Update the text on the screen.
-        view_port_update(view_port);
+// Function to create a device and load its remote, keeping it only if that worked.
+static bool add_device(const AcDeviceConfig* config, ViewPort* view_port) {
+    AcDevice* device =
+        ac_device_alloc(config, scheduler, tx_worker, device_changed_callback, view_port);
+    if(!ac_device_load(device)) {
+        ac_device_free(device);
+        return false;
     }
+
+    // Look up where the unit was left off the last time the app ran.
+    has_saved_state[devices_count] =
+        ac_device_state_load(state_path, config->name, &saved_states[devices_count]);
+    devices[devices_count++] = device;
+    return true;
 }
 
-// Timer callback to update the countdown displayed on-screen.
-static void update_countdown(void* ctx) {
-    ViewPort* view_port = (ViewPort*)ctx;
+// Loader thread: reads the devices, their remotes and sequences off the main thread,
+// so the loading screen is drawn right away however large the files are.
+static int32_t ac_app_loader(void* ctx) {
+    AcAppLoaderContext* loader_context = (AcAppLoaderContext*)ctx;
 
-    if(remaining_time >= one_minute_interval) {
-        remaining_time -= one_minute_interval; // Decrease by 1 minute at a time.
-    } else {
-        remaining_time = 0;
+    AcDeviceConfig* configs = malloc(AC_APP_MAX_DEVICES * sizeof(AcDeviceConfig));
+    size_t configs_count = ac_device_config_load(devices_path, configs, AC_APP_MAX_DEVICES);
+
+    for(size_t i = 0; i < configs_count; ++i) {
+        if(!add_device(&configs[i], loader_context->view_port)) {
+            FURI_LOG_E("ac_app", "Could not load %s", configs[i].remote_path);
+        }
     }
 
-    // Log the remaining time.
-    uint32_t remaining_minutes = remaining_time / one_minute_interval;
-    if(remaining_minutes == 1) {
-        FURI_LOG_I("countdown", "Time remaining until next signal: 1 minute");
-    } else {
-        FURI_LOG_I(
-            "countdown", "Time remaining until next signal: %lu minutes", remaining_minutes);
+    if(configs_count == 0) {
+        // A single unit on the default cycle: 1 hour on, 3 hours off.
+        AcDeviceConfig* config = &configs[0];
+        strcpy(config->name, "A/C");
+        config->on_ms = one_hour_interval;
+        config->off_ms = three_hour_interval;
+        config->offset_ms = 0;
+        config->verify_mode = AcVerifyModeNone;
+        config->verify_pin = NULL;
+
+        for(size_t i = 0; i < COUNT_OF(remote_paths); ++i) {
+            strcpy(config->remote_path, remote_paths[i]);
+            if(add_device(config, loader_context->view_port)) break;
+        }
     }
 
-    // Update the text on the screen.
-    view_port_update(view_port);
+    free(configs);
 
-    // Schedule the next countdown update in one minute.
-    furi_timer_stop(countdown_timer);
-    furi_timer_start(countdown_timer, one_minute_interval);
+    AcAppEvent loaded_event = {.type = AcAppEventTypeLoaded};
+    furi_message_queue_put(loader_context->event_queue, &loaded_event, FuriWaitForever);
+
+    return 0;
 }
 
-// Handle input.
+// Handle input: OK toggles the statistics, Back closes them or the application, Down
+// turns the screen off, and holding OK decodes the event trace to the log. Headless, any
+// key wakes the app up and is swallowed until released, so it does nothing else.
 static void ac_app_input_callback(InputEvent* input_event, void* ctx) {
     furi_assert(ctx);
-    if(input_event->key == InputKeyBack && input_event->type == InputTypeShort) {
-        FURI_LOG_I("ac_app", "Received input to close the application.");
-        FuriMessageQueue* event_queue = (FuriMessageQueue*)ctx;
-        InputEvent exit_event = {.type = InputTypeShort, .key = InputKeyBack};
-        furi_message_queue_put(event_queue, &exit_event, FuriWaitForever);
+    FuriMessageQueue* event_queue = (FuriMessageQueue*)ctx;
+
+    if(headless) {
+        if(input_event->type == InputTypePress) {
+            wake_key = input_event->key;
+            AcAppEvent wake_event = {.type = AcAppEventTypeWake};
+            furi_message_queue_put(event_queue, &wake_event, 0);
+        } else if(input_event->type == InputTypeRelease && input_event->key == wake_key) {
+            wake_key = InputKeyMAX;
+        }
+        return;
+    } else if(input_event->key == wake_key) {
+        // Still held from waking up, the screen may have come back in the meantime.
+        if(input_event->type == InputTypeRelease) {
+            wake_key = InputKeyMAX;
+        }
+        return;
+    }
+
+    if((input_event->key == InputKeyBack || input_event->key == InputKeyOk ||
+        input_event->key == InputKeyDown) &&
+       (input_event->type == InputTypeShort || input_event->type == InputTypeLong)) {
+        AcAppEvent app_event = {.type = AcAppEventTypeInput, .input = *input_event};
+        furi_message_queue_put(event_queue, &app_event, FuriWaitForever);
+    }
+}
+
+// Function to turn the screen off or back on. Only the main loop calls it.
+static void set_headless(bool enable, ViewPort* view_port, NotificationApp* notification) {
+    if(headless == enable) return;
+    headless = enable;
+
+    notification_message(
+        notification,
+        enable ? &sequence_display_backlight_off : &sequence_display_backlight_on);
+
+    // The devices are only there once the loader thread is done, which schedules the
+    // countdown itself. Until then, the loading screen is all there is to draw.
+    if(!loading) {
+        // The countdown is only kept up to date while it can be seen.
+        schedule_countdown_update(view_port);
+        if(!enable) {
+            update_text();
+        }
+    }
+    if(enable) {
+        // Blank the screen once, nothing is drawn from now on.
+        view_port_update(view_port);
+    } else {
+        request_redraw();
     }
 }
 
 int32_t ac_app_app(void* p) { // The actual sequence of events.
-    UNUSED(p);
+    // Launched with "headless" as its argument, the app starts with the screen off.
+    const char* args = p;
+    const bool start_headless = args && strcmp(args, "headless") == 0;
 
-    FuriMessageQueue* event_queue = furi_message_queue_alloc(8, sizeof(InputEvent));
+    FuriMessageQueue* event_queue = furi_message_queue_alloc(8, sizeof(AcAppEvent));
+    text_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
     FURI_LOG_I("ac_app", "The app started.");
+    ac_trace_record(AcTraceEventAppStart, 0, 0);
 
     // Creating and configuring a ViewPort.
     ViewPort* view_port = view_port_alloc();
@@ -185,44 +374,107 @@ int32_t ac_app_app(void* p) { // The actual sequence of events.
     Gui* gui = furi_record_open(RECORD_GUI);
     gui_add_view_port(gui, view_port, GuiLayerFullscreen);
 
-    // Initialize the timers.
-    signal_timer = furi_timer_alloc(send_signals_and_update_text, FuriTimerTypeOnce, view_port);
-    countdown_timer = furi_timer_alloc(update_countdown, FuriTimerTypeOnce, view_port);
-    sequence_timer = furi_timer_alloc(sequence_step_callback, FuriTimerTypeOnce, view_port);
+    NotificationApp* notification = furi_record_open(RECORD_NOTIFICATION);
 
-    // Start sending signals.
-    send_signals_and_update_text(view_port);
+    // Start the TX worker before anything can be sent. All units share it, so their
+    // transmissions are sent one after another and never overlap.
+    tx_worker = ac_tx_worker_alloc();
+    ac_tx_worker_start(tx_worker);
 
-    // Schedule the first countdown update in 1 minute.
-    furi_timer_start(countdown_timer, one_minute_interval);
+    scheduler = ac_scheduler_alloc();
+    if(start_headless) {
+        set_headless(true, view_port, notification);
+    }
 
-    // Run the input event loop so the app doesn't stop until we say so.
-    InputEvent event;
+    // Load the devices in the background while the loading screen is up.
+    AcAppLoaderContext loader_context = {.view_port = view_port, .event_queue = event_queue};
+    FuriThread* loader =
+        furi_thread_alloc_ex("AcAppLoader", 2 * 1024, ac_app_loader, &loader_context);
+    furi_thread_start(loader);
+
+    // Run the event loop so the app doesn't stop until we say so. Input and scheduled
+    // events are all handled here, on the app thread, and whatever they change on-screen
+    // is redrawn once at the end of the iteration.
+    AcAppEvent event;
     while(true) {
-        if(furi_message_queue_get(event_queue, &event, FuriWaitForever) == FuriStatusOk) {
-            if(event.key == InputKeyBack) {
-                FURI_LOG_I("ac_app", "Closing the application!");
-                break;
+        const FuriStatus status =
+            furi_message_queue_get(event_queue, &event, ac_scheduler_get_timeout(scheduler));
+        if(status != FuriStatusOk) {
+            // Nothing received: a scheduled event is due.
+        } else if(event.type == AcAppEventTypeWake) {
+            set_headless(false, view_port, notification);
+        } else if(event.type == AcAppEventTypeLoaded) {
+            furi_thread_join(loader);
+
+            // Resume cycling the units where they were left, or start them from their offsets.
+            // Resuming a switch sends its next step right away, still as part of loading, so
+            // that the states of the units yet to be started aren't saved.
+            for(size_t i = 0; i < devices_count; ++i) {
+                if(!has_saved_state[i] || !ac_device_resume(devices[i], &saved_states[i])) {
+                    ac_device_start(devices[i]);
+                }
+            }
+            loading = false;
+            if(devices_count == 0) {
+                FURI_LOG_E("ac_app", "No remote file could be loaded.");
+            } else {
+                ac_device_state_save(state_path, devices, devices_count);
+                schedule_countdown_update(view_port);
+            }
+            update_text();
+            request_redraw();
+        } else if(event.input.type == InputTypeLong) {
+            if(event.input.key == InputKeyOk) {
+                ac_trace_log();
             }
+        } else if(event.input.key == InputKeyDown) {
+            set_headless(true, view_port, notification);
+        } else if(event.input.key == InputKeyOk || showing_stats) {
+            showing_stats = !showing_stats;
+            request_redraw();
+        } else if(event.input.key == InputKeyBack) {
+            FURI_LOG_I("ac_app", "Closing the application!");
+            break;
         }
-    }
 
-    // Cleanup.
-    if(signal_timer) {
-        furi_timer_stop(signal_timer);
-        furi_timer_free(signal_timer);
-    }
-    if(countdown_timer) {
-        furi_timer_stop(countdown_timer);
-        furi_timer_free(countdown_timer);
+        ac_scheduler_dispatch(scheduler);
+
+        if(redraw_pending && !headless) {
+            redraw_pending = false;
+            view_port_update(view_port);
+        }
     }
-    if(sequence_timer) {
-        furi_timer_stop(sequence_timer);
-        furi_timer_free(sequence_timer);
+
+    // Cleanup. The loader can't be interrupted, so an early exit waits for it.
+    furi_thread_join(loader);
+    furi_thread_free(loader);
+    // The worker may still hold remote signals, so it goes first.
+    ac_tx_worker_stop(tx_worker);
+    ac_tx_worker_free(tx_worker);
+    tx_worker = NULL;
+    ac_stats_log();
+    ac_trace_record(AcTraceEventAppStop, 0, 0);
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    ac_trace_save(storage, trace_path);
+    furi_record_close(RECORD_STORAGE);
+    for(size_t i = 0; i < devices_count; ++i) {
+        ac_device_free(devices[i]);
+        devices[i] = NULL;
     }
+    devices_count = 0;
+    ac_scheduler_free(scheduler);
+    scheduler = NULL;
     gui_remove_view_port(gui, view_port);
     view_port_free(view_port);
+    if(headless) {
+        notification_message(notification, &sequence_display_backlight_on);
+        headless = false;
+    }
+    furi_record_close(RECORD_NOTIFICATION);
     furi_record_close(RECORD_GUI);
+    furi_mutex_free(text_mutex);
+    text_mutex = NULL;
     furi_message_queue_free(event_queue);
 
     return 0;
@@ -0,0 +1,689 @@
+#include "ac_device.h"
+#include "ac_remote.h"
+#include "ac_sequence.h"
+#include "ac_trace.h"
+
+#include <furi.h>
+#include <furi_hal_rtc.h>
+#include <flipper_format/flipper_format.h>
+#include <storage/storage.h>
+
+#define TAG "AcDevice"
+
+#define AC_DEVICE_FILE_TYPE "AC devices file"
+#define AC_DEVICE_FILE_VERSION 2
+#define AC_DEVICE_FILE_VERSION_NO_VERIFY 1 // Still accepted, without the verify key
+
+#define AC_DEVICE_NAME_KEY "name"
+#define AC_DEVICE_REMOTE_KEY "remote"
+#define AC_DEVICE_ON_KEY "on_minutes"
+#define AC_DEVICE_OFF_KEY "off_minutes"
+#define AC_DEVICE_OFFSET_KEY "offset_minutes"
+#define AC_DEVICE_VERIFY_KEY "verify"
+
+#define AC_DEVICE_STATE_FILE_TYPE "AC state file"
+#define AC_DEVICE_STATE_FILE_VERSION 2
+#define AC_DEVICE_STATE_FILE_VERSION_NO_SWITCH 1 // Still accepted, without the switch keys
+
+#define AC_DEVICE_STATE_ON_KEY "on_ms"
+#define AC_DEVICE_STATE_OFF_KEY "off_ms"
+#define AC_DEVICE_STATE_IS_ON_KEY "is_on"
+#define AC_DEVICE_STATE_TARGET_KEY "target"
+#define AC_DEVICE_STATE_TARGET_ON_KEY "target_on"
+#define AC_DEVICE_STATE_SWITCHING_KEY "switching"
+#define AC_DEVICE_STATE_SWITCH_ON_KEY "switch_on"
+#define AC_DEVICE_STATE_STEPS_SENT_KEY "steps_sent"
+
+#define AC_DEVICE_MINUTE_MS 60000UL
+
+#define AC_DEVICE_VERIFY_POLL_MS 100 // Wait for the TX worker or the receiver
+#define AC_DEVICE_VERIFY_WINDOW_MS 3000 // Time given to the unit to acknowledge
+#define AC_DEVICE_VERIFY_BACKOFF_MS 5000 // Before the first retry, doubled for each one
+#define AC_DEVICE_VERIFY_MAX_RETRIES 3
+
+// Sequences to be run, by name. The .seq file next to the remote may redefine them.
+static const char* turn_on_sequence_name = "Turn_on";
+static const char* turn_off_sequence_name = "Turn_off";
+
+// Acknowledgements sent back by the unit, learned into the remote for AcVerifyModeIr.
+static const char* ack_on_signal_name = "Ack_on";
+static const char* ack_off_signal_name = "Ack_off";
+
+// Built-in sequences: Power, then Mode twice, one second apart, to turn on.
+static const AcSequenceStep turn_on_steps[] = {
+    {.signal = "Power", .delay_ms = 1000, .repeat = 1},
+    {.signal = "Mode", .delay_ms = 1000, .repeat = 1},
+    {.signal = "Mode", .delay_ms = 0, .repeat = 1},
+};
+static const AcSequenceStep turn_off_steps[] = {
+    {.signal = "Power", .delay_ms = 0, .repeat = 1},
+};
+
+struct AcDevice {
+    AcDeviceConfig config;
+    AcScheduler* scheduler;
+    AcTxWorker* tx_worker;
+    AcDeviceChangedCallback changed_callback;
+    void* context;
+
+    AcRemote* remote; // NULL until loaded.
+    AcSequenceSet* sequences;
+    AcSequencer* sequencer;
+    AcVerifier* verifier; // NULL without verification.
+
+    bool is_on;
+    bool started; // Whether a sequence has been sent since the device was started.
+    bool target_on; // State the unit is switched to at target.
+    uint32_t target; // RTC timestamp at which the next switch is due.
+    uint32_t deadline; // Tick at which target is expected to be reached.
+    AcSchedulerId event; // Next switch, AC_SCHEDULER_ID_NONE while a sequence is running.
+    AcDeviceState state; // What gets saved, see ac_device_update_state().
+
+    bool verifying; // A sequence was sent and is being confirmed or retried.
+    bool verify_on; // State the unit should have switched to.
+    uint32_t verify_retries; // Retries made for the current switch.
+    AcSchedulerId verify_event;
+};
+
+size_t ac_device_config_load(const char* path, AcDeviceConfig* configs, size_t max_count) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    FlipperFormat* ff = flipper_format_buffered_file_alloc(storage);
+    FuriString* tmp = furi_string_alloc();
+    size_t count = 0;
+
+    do {
+        if(!storage_file_exists(storage, path)) break;
+        if(!flipper_format_buffered_file_open_existing(ff, path)) break;
+
+        uint32_t version;
+        if(!flipper_format_read_header(ff, tmp, &version)) break;
+        if(!furi_string_equal(tmp, AC_DEVICE_FILE_TYPE) ||
+           (version != AC_DEVICE_FILE_VERSION && version != AC_DEVICE_FILE_VERSION_NO_VERIFY)) {
+            FURI_LOG_E(TAG, "Unsupported file: %s", path);
+            break;
+        }
+
+        while(count < max_count && flipper_format_read_string(ff, AC_DEVICE_NAME_KEY, tmp)) {
+            AcDeviceConfig* config = &configs[count];
+            uint32_t on_minutes, off_minutes, offset_minutes;
+
+            if(furi_string_size(tmp) >= AC_DEVICE_NAME_SIZE) break;
+            strcpy(config->name, furi_string_get_cstr(tmp));
+
+            if(!flipper_format_read_string(ff, AC_DEVICE_REMOTE_KEY, tmp) ||
+               furi_string_size(tmp) >= AC_DEVICE_PATH_SIZE) {
+                break;
+            }
+            strcpy(config->remote_path, furi_string_get_cstr(tmp));
+
+            if(!flipper_format_read_uint32(ff, AC_DEVICE_ON_KEY, &on_minutes, 1) ||
+               !flipper_format_read_uint32(ff, AC_DEVICE_OFF_KEY, &off_minutes, 1) ||
+               !flipper_format_read_uint32(ff, AC_DEVICE_OFFSET_KEY, &offset_minutes, 1)) {
+                break;
+            }
+
+            // Deadlines are ticks compared with wraparound, so they must stay well within range.
+            if(on_minutes == 0 || off_minutes == 0 || on_minutes > 24 * 60 ||
+               off_minutes > 24 * 60 || offset_minutes > 24 * 60) {
+                FURI_LOG_E(TAG, "Invalid durations for %s", config->name);
+                break;
+            }
+
+            config->on_ms = on_minutes * AC_DEVICE_MINUTE_MS;
+            config->off_ms = off_minutes * AC_DEVICE_MINUTE_MS;
+            config->offset_ms = offset_minutes * AC_DEVICE_MINUTE_MS;
+
+            config->verify_mode = AcVerifyModeNone;
+            config->verify_pin = NULL;
+            if(version == AC_DEVICE_FILE_VERSION &&
+               (!flipper_format_read_string(ff, AC_DEVICE_VERIFY_KEY, tmp) ||
+                !ac_verifier_parse(
+                    furi_string_get_cstr(tmp), &config->verify_mode, &config->verify_pin))) {
+                break;
+            }
+
+            count++;
+        }
+    } while(false);
+
+    furi_string_free(tmp);
+    flipper_format_free(ff);
+    furi_record_close(RECORD_STORAGE);
+
+    return count;
+}
+
+static void ac_device_notify(AcDevice* device) {
+    if(device->changed_callback) {
+        device->changed_callback(device, device->context);
+    }
+}
+
+static void ac_device_update_state(AcDevice* device);
+
+// Send the infrared signal of a sequence step. It is only queued here, the TX worker
+// does the actual (blocking) transmission, one device after another.
+static void ac_device_send_callback(
+    const AcSequenceStep* step,
+    uint32_t deadline,
+    uint32_t run,
+    void* context) {
+    AcDevice* device = context;
+
+    const InfraredSignal* signal = ac_remote_get_signal(device->remote, step->signal);
+    if(!signal) {
+        FURI_LOG_E(TAG, "%s: signal not available: %s", device->config.name, step->signal);
+    } else {
+        const AcTxWorkerTiming timing = {.deadline = deadline, .sequence = run};
+        const bool queued =
+            step->hold ?
+                ac_tx_worker_enqueue_hold(device->tx_worker, signal, step->repeat, &timing) :
+                ac_tx_worker_enqueue_burst(
+                    device->tx_worker, signal, step->repeat, step->delay_ms, &timing);
+        if(queued) {
+            ac_trace_record(AcTraceEventStepQueued, step->repeat, step->hold);
+        }
+    }
+
+    // Every step moves the switch along, so that a restart doesn't send it again.
+    ac_device_update_state(device);
+    ac_device_notify(device);
+}
+
+// Length of a phase of the cycle, in seconds of RTC time.
+static uint32_t ac_device_get_phase_length(const AcDevice* device, bool on) {
+    return (on ? device->config.on_ms : device->config.off_ms) / 1000;
+}
+
+static const AcSequence* ac_device_get_sequence(const AcDevice* device, bool on) {
+    const char* name = on ? turn_on_sequence_name : turn_off_sequence_name;
+    return ac_sequence_set_get(device->sequences, name);
+}
+
+// Take a snapshot of the state, along with how far the switch in progress got: the
+// steps handed over by the sequencer, or all of them while the switch is being verified.
+static void ac_device_update_state(AcDevice* device) {
+    device->state.on_ms = device->config.on_ms;
+    device->state.off_ms = device->config.off_ms;
+    device->state.target = device->target;
+    device->state.target_on = device->target_on;
+    device->state.is_on = device->is_on;
+
+    // The target has already moved on to the next switch, past the one in progress.
+    device->state.switching = ac_device_is_switching(device);
+    device->state.switch_on = device->state.switching && !device->target_on;
+    if(ac_sequencer_is_running(device->sequencer)) {
+        device->state.steps_sent = ac_sequencer_get_step(device->sequencer);
+    } else if(device->verifying) {
+        device->state.steps_sent = ac_sequence_get_steps_count(
+            ac_device_get_sequence(device, device->verify_on));
+    } else {
+        device->state.steps_sent = 0;
+    }
+}
+
+static void ac_device_event_callback(void* context);
+
+// Schedule the scheduler event for the RTC target. Ticks and the RTC may drift apart,
+// so the target is checked again against the RTC once the event is due.
+static void ac_device_schedule(AcDevice* device) {
+    const uint32_t now = furi_hal_rtc_get_timestamp();
+    const uint32_t wait_s = (int32_t)(device->target - now) > 0 ? device->target - now : 0;
+
+    device->deadline = furi_get_tick() + wait_s * 1000;
+
+    ac_scheduler_cancel(device->scheduler, device->event);
+    device->event =
+        ac_scheduler_add(device->scheduler, device->deadline, ac_device_event_callback, device);
+}
+
+// The switch is done, confirmed or not: schedule the next one.
+static void ac_device_complete_switch(AcDevice* device, bool on) {
+    device->verifying = false;
+    device->verify_retries = 0;
+
+    device->is_on = on;
+    ac_device_update_state(device);
+    ac_device_schedule(device);
+
+    ac_trace_record(AcTraceEventStateChanged, device->is_on, furi_hal_rtc_get_timestamp());
+    ac_device_notify(device);
+}
+
+static void ac_device_verify_start_callback(void* context);
+
+static void ac_device_schedule_verify(
+    AcDevice* device,
+    uint32_t interval,
+    AcSchedulerCallback callback) {
+    device->verify_event =
+        ac_scheduler_add(device->scheduler, furi_get_tick() + interval, callback, device);
+}
+
+static void ac_device_start_sequence(AcDevice* device, bool on) {
+    ac_sequencer_start(device->sequencer, ac_device_get_sequence(device, on));
+}
+
+// Whether an unconfirmed switch may be sent again. If a signal is in both sequences, e.g.
+// a toggling Power button, resending undoes a switch that worked but went unacknowledged,
+// so only a sensor showing the unit still in the other state justifies it.
+static bool ac_device_can_retry(const AcDevice* device) {
+    if(device->config.verify_mode == AcVerifyModeGpio) return true;
+
+    return !ac_sequence_shares_signal(
+        ac_device_get_sequence(device, true), ac_device_get_sequence(device, false));
+}
+
+// Scheduler callback, sends the sequence of an unconfirmed switch again.
+static void ac_device_verify_retry_callback(void* context) {
+    AcDevice* device = context;
+    device->verify_event = AC_SCHEDULER_ID_NONE;
+
+    // The unit may have switched late, in which case a toggle would switch it back.
+    if(device->config.verify_mode == AcVerifyModeGpio &&
+       ac_verifier_finish(device->verifier, device->verify_on)) {
+        ac_trace_record(AcTraceEventVerify, device->verify_retries, true);
+        ac_device_complete_switch(device, device->verify_on);
+        return;
+    }
+
+    // Reported by the send callback, as for the first attempt.
+    ac_device_start_sequence(device, device->verify_on);
+}
+
+// Scheduler callback, checks whether the unit switched once it was given the time to.
+static void ac_device_verify_check_callback(void* context) {
+    AcDevice* device = context;
+    device->verify_event = AC_SCHEDULER_ID_NONE;
+
+    const bool confirmed = ac_verifier_finish(device->verifier, device->verify_on);
+    ac_trace_record(AcTraceEventVerify, device->verify_retries, confirmed);
+
+    if(confirmed) {
+        ac_device_complete_switch(device, device->verify_on);
+    } else if(!ac_device_can_retry(device)) {
+        FURI_LOG_W(TAG, "%s: switch not confirmed, toggles are not resent", device->config.name);
+        ac_device_complete_switch(device, device->verify_on);
+    } else if(device->verify_retries == AC_DEVICE_VERIFY_MAX_RETRIES) {
+        FURI_LOG_E(TAG, "%s: switch not confirmed, giving up", device->config.name);
+        ac_device_complete_switch(device, device->verify_on);
+    } else {
+        const uint32_t backoff = AC_DEVICE_VERIFY_BACKOFF_MS << device->verify_retries++;
+        FURI_LOG_W(TAG, "%s: switch not confirmed, retrying", device->config.name);
+        ac_device_schedule_verify(device, backoff, ac_device_verify_retry_callback);
+    }
+}
+
+// Scheduler callback, starts the check once everything has been sent.
+static void ac_device_verify_start_callback(void* context) {
+    AcDevice* device = context;
+    device->verify_event = AC_SCHEDULER_ID_NONE;
+
+    const InfraredMessage* ack = NULL;
+    if(device->config.verify_mode == AcVerifyModeIr) {
+        const char* name = device->verify_on ? ack_on_signal_name : ack_off_signal_name;
+        const InfraredSignal* signal = ac_remote_get_signal(device->remote, name);
+        if(!signal || infrared_signal_is_raw(signal)) {
+            FURI_LOG_E(
+                TAG, "%s: no decoded %s signal to verify with", device->config.name, name);
+            ac_device_complete_switch(device, device->verify_on);
+            return;
+        }
+        ack = infrared_signal_get_message(signal);
+    }
+
+    // Signals still on air would be picked up by the receiver.
+    if(!ac_tx_worker_is_idle(device->tx_worker) || !ac_verifier_start(device->verifier, ack)) {
+        ac_device_schedule_verify(
+            device, AC_DEVICE_VERIFY_POLL_MS, ac_device_verify_start_callback);
+        return;
+    }
+
+    ac_device_schedule_verify(device, AC_DEVICE_VERIFY_WINDOW_MS, ac_device_verify_check_callback);
+}
+
+// Sequencer callback, invoked once the turn-on or turn-off sequence has been sent.
+static void ac_device_done_callback(const AcSequence* sequence, void* context) {
+    AcDevice* device = context;
+    const bool on = strcmp(ac_sequence_get_name(sequence), turn_on_sequence_name) == 0;
+
+    if(!device->verifier) {
+        ac_device_complete_switch(device, on);
+        return;
+    }
+
+    device->verifying = true;
+    device->verify_on = on;
+    ac_device_schedule_verify(device, AC_DEVICE_VERIFY_POLL_MS, ac_device_verify_start_callback);
+    ac_device_update_state(device);
+    ac_device_notify(device);
+}
+
+// Scheduler callback, starts the sequence switching the unit to the state of the
+// phase that has begun. Phases are laid out back to back from the start of the
+// device, so the cycle stays aligned to the RTC however long sequences take.
+static void ac_device_event_callback(void* context) {
+    AcDevice* device = context;
+    device->event = AC_SCHEDULER_ID_NONE;
+
+    const uint32_t now = furi_hal_rtc_get_timestamp();
+    if((int32_t)(device->target - now) > 0) {
+        // Ticks ran ahead of the RTC, wait for the rest.
+        ac_device_schedule(device);
+        return;
+    }
+
+    // Catch-up policy: phases that ended while the app was busy or asleep are skipped,
+    // rather than replayed, and the unit goes straight to the state of the current one.
+    uint32_t skipped = 0;
+    while((int32_t)(now - device->target) >=
+          (int32_t)ac_device_get_phase_length(device, device->target_on)) {
+        device->target += ac_device_get_phase_length(device, device->target_on);
+        device->target_on = !device->target_on;
+        skipped++;
+    }
+    if(skipped) {
+        FURI_LOG_W(TAG, "%s: skipped %lu missed switches", device->config.name, skipped);
+    }
+    ac_trace_record(AcTraceEventSwitchDue, skipped, now);
+
+    const bool on = device->target_on;
+    device->target += ac_device_get_phase_length(device, on);
+    device->target_on = !on;
+
+    if(device->started && on == device->is_on) {
+        // Already in the state of the current phase, only the next switch is scheduled.
+        ac_device_update_state(device);
+        ac_device_schedule(device);
+        ac_device_notify(device);
+        return;
+    }
+
+    // Reported by the send callback as the first step goes out.
+    device->started = true;
+    ac_device_start_sequence(device, on);
+}
+
+AcDevice* ac_device_alloc(
+    const AcDeviceConfig* config,
+    AcScheduler* scheduler,
+    AcTxWorker* tx_worker,
+    AcDeviceChangedCallback changed_callback,
+    void* context) {
+    AcDevice* device = malloc(sizeof(AcDevice));
+
+    device->config = *config;
+    device->scheduler = scheduler;
+    device->tx_worker = tx_worker;
+    device->changed_callback = changed_callback;
+    device->context = context;
+
+    device->remote = NULL;
+    device->sequences = NULL;
+    device->sequencer =
+        ac_sequencer_alloc(scheduler, ac_device_send_callback, ac_device_done_callback, device);
+    device->verifier = config->verify_mode == AcVerifyModeNone ?
+                           NULL :
+                           ac_verifier_alloc(config->verify_mode, config->verify_pin);
+
+    device->is_on = false;
+    device->started = false;
+    device->target_on = true;
+    device->target = 0;
+    device->deadline = 0;
+    device->event = AC_SCHEDULER_ID_NONE;
+    ac_device_update_state(device);
+
+    device->verifying = false;
+    device->verify_on = false;
+    device->verify_retries = 0;
+    device->verify_event = AC_SCHEDULER_ID_NONE;
+
+    return device;
+}
+
+void ac_device_free(AcDevice* device) {
+    ac_scheduler_cancel(device->scheduler, device->event);
+    ac_scheduler_cancel(device->scheduler, device->verify_event);
+    ac_sequencer_free(device->sequencer);
+    if(device->verifier) {
+        ac_verifier_free(device->verifier);
+    }
+
+    if(device->sequences) {
+        ac_sequence_set_free(device->sequences);
+    }
+    if(device->remote) {
+        ac_remote_free(device->remote);
+    }
+
+    free(device);
+}
+
+// Set up the sequences: built-in ones first, so the sequence file next to the
+// remote (e.g. Ac.seq) only has to list the ones it changes.
+static void ac_device_load_sequences(AcDevice* device) {
+    device->sequences = ac_sequence_set_alloc();
+    ac_sequence_set_add(
+        device->sequences, turn_on_sequence_name, turn_on_steps, COUNT_OF(turn_on_steps));
+    ac_sequence_set_add(
+        device->sequences, turn_off_sequence_name, turn_off_steps, COUNT_OF(turn_off_steps));
+
+    FuriString* sequence_path = furi_string_alloc_set_str(device->config.remote_path);
+    size_t extension = furi_string_search_rchar(sequence_path, '.', 0);
+    if(extension != FURI_STRING_FAILURE) {
+        furi_string_left(sequence_path, extension);
+    }
+    furi_string_cat_str(sequence_path, ".seq");
+
+    const char* path = furi_string_get_cstr(sequence_path);
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    if(storage_file_exists(storage, path)) {
+        ac_sequence_set_load(device->sequences, path);
+    }
+    furi_record_close(RECORD_STORAGE);
+    furi_string_free(sequence_path);
+}
+
+bool ac_device_load(AcDevice* device) {
+    furi_assert(device->remote == NULL);
+
+    // Only signal names are read here, bodies are parsed on first use.
+    AcRemote* remote = ac_remote_alloc();
+    ac_remote_set_canonicalize(remote, true);
+    if(!ac_remote_load(remote, device->config.remote_path)) {
+        ac_remote_free(remote);
+        return false;
+    }
+
+    device->remote = remote;
+    ac_device_load_sequences(device);
+
+    return true;
+}
+
+bool ac_device_is_loaded(const AcDevice* device) {
+    return device->remote != NULL;
+}
+
+void ac_device_start(AcDevice* device) {
+    furi_assert(device->remote);
+
+    device->is_on = false;
+    device->started = false;
+    device->target_on = true;
+    device->target = furi_hal_rtc_get_timestamp() + device->config.offset_ms / 1000;
+    ac_device_update_state(device);
+    ac_device_schedule(device);
+}
+
+bool ac_device_resume(AcDevice* device, const AcDeviceState* state) {
+    furi_assert(device->remote);
+
+    if(state->on_ms != device->config.on_ms || state->off_ms != device->config.off_ms) {
+        FURI_LOG_I(TAG, "%s: cycle changed, starting over", device->config.name);
+        return false;
+    }
+
+    // A target further away than a whole cycle means the clock was set back.
+    const uint32_t now = furi_hal_rtc_get_timestamp();
+    const uint32_t cycle = ac_device_get_phase_length(device, true) +
+                           ac_device_get_phase_length(device, false) +
+                           device->config.offset_ms / 1000;
+    if((int32_t)(state->target - now) > (int32_t)cycle) {
+        FURI_LOG_W(TAG, "%s: saved state is ahead of the clock", device->config.name);
+        return false;
+    }
+
+    device->is_on = state->is_on;
+    device->started = true;
+    device->target_on = state->target_on;
+    device->target = state->target;
+
+    if(state->switching) {
+        // Finish the switch first. Its next one is scheduled once it is complete, which
+        // catches up on the time spent in between.
+        const AcSequence* sequence = ac_device_get_sequence(device, state->switch_on);
+        const size_t steps_count = ac_sequence_get_steps_count(sequence);
+        FURI_LOG_I(
+            TAG,
+            "%s: resuming switch after %lu of %zu steps",
+            device->config.name,
+            state->steps_sent,
+            steps_count);
+
+        if(state->steps_sent < steps_count) {
+            ac_sequencer_start_at(device->sequencer, sequence, state->steps_sent);
+        } else {
+            ac_device_done_callback(sequence, device);
+        }
+    } else {
+        ac_device_update_state(device);
+        ac_device_schedule(device);
+    }
+
+    return true;
+}
+
+void ac_device_get_state(const AcDevice* device, AcDeviceState* state) {
+    *state = device->state;
+}
+
+bool ac_device_is_switching(const AcDevice* device) {
+    return ac_sequencer_is_running(device->sequencer) || device->verifying;
+}
+
+bool ac_device_state_save(const char* path, AcDevice* const* devices, size_t count) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    FlipperFormat* ff = flipper_format_file_alloc(storage);
+    bool success = false;
+
+    do {
+        if(!flipper_format_file_open_always(ff, path)) break;
+        if(!flipper_format_write_header_cstr(
+               ff, AC_DEVICE_STATE_FILE_TYPE, AC_DEVICE_STATE_FILE_VERSION)) {
+            break;
+        }
+
+        bool devices_ok = true;
+        for(size_t i = 0; devices_ok && i < count; ++i) {
+            const AcDeviceState* state = &devices[i]->state;
+            devices_ok =
+                flipper_format_write_string_cstr(
+                    ff, AC_DEVICE_NAME_KEY, devices[i]->config.name) &&
+                flipper_format_write_uint32(ff, AC_DEVICE_STATE_ON_KEY, &state->on_ms, 1) &&
+                flipper_format_write_uint32(ff, AC_DEVICE_STATE_OFF_KEY, &state->off_ms, 1) &&
+                flipper_format_write_bool(ff, AC_DEVICE_STATE_IS_ON_KEY, &state->is_on, 1) &&
+                flipper_format_write_uint32(
+                    ff, AC_DEVICE_STATE_TARGET_KEY, &state->target, 1) &&
+                flipper_format_write_bool(
+                    ff, AC_DEVICE_STATE_TARGET_ON_KEY, &state->target_on, 1) &&
+                flipper_format_write_bool(
+                    ff, AC_DEVICE_STATE_SWITCHING_KEY, &state->switching, 1) &&
+                flipper_format_write_bool(
+                    ff, AC_DEVICE_STATE_SWITCH_ON_KEY, &state->switch_on, 1) &&
+                flipper_format_write_uint32(
+                    ff, AC_DEVICE_STATE_STEPS_SENT_KEY, &state->steps_sent, 1);
+        }
+
+        success = devices_ok;
+    } while(false);
+
+    if(!success) {
+        FURI_LOG_E(TAG, "Failed to save %s", path);
+    }
+
+    flipper_format_free(ff);
+    furi_record_close(RECORD_STORAGE);
+
+    return success;
+}
+
+bool ac_device_state_load(const char* path, const char* name, AcDeviceState* state) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    FlipperFormat* ff = flipper_format_buffered_file_alloc(storage);
+    FuriString* tmp = furi_string_alloc();
+    bool found = false;
+
+    do {
+        if(!storage_file_exists(storage, path)) break;
+        if(!flipper_format_buffered_file_open_existing(ff, path)) break;
+
+        uint32_t version;
+        if(!flipper_format_read_header(ff, tmp, &version)) break;
+        if(!furi_string_equal(tmp, AC_DEVICE_STATE_FILE_TYPE) ||
+           (version != AC_DEVICE_STATE_FILE_VERSION &&
+            version != AC_DEVICE_STATE_FILE_VERSION_NO_SWITCH)) {
+            break;
+        }
+
+        while(!found && flipper_format_read_string(ff, AC_DEVICE_NAME_KEY, tmp)) {
+            AcDeviceState entry = {.switching = false, .switch_on = false, .steps_sent = 0};
+            if(!flipper_format_read_uint32(ff, AC_DEVICE_STATE_ON_KEY, &entry.on_ms, 1) ||
+               !flipper_format_read_uint32(ff, AC_DEVICE_STATE_OFF_KEY, &entry.off_ms, 1) ||
+               !flipper_format_read_bool(ff, AC_DEVICE_STATE_IS_ON_KEY, &entry.is_on, 1) ||
+               !flipper_format_read_uint32(ff, AC_DEVICE_STATE_TARGET_KEY, &entry.target, 1) ||
+               !flipper_format_read_bool(
+                   ff, AC_DEVICE_STATE_TARGET_ON_KEY, &entry.target_on, 1)) {
+                break;
+            }
+            if(version == AC_DEVICE_STATE_FILE_VERSION &&
+               (!flipper_format_read_bool(
+                    ff, AC_DEVICE_STATE_SWITCHING_KEY, &entry.switching, 1) ||
+                !flipper_format_read_bool(
+                    ff, AC_DEVICE_STATE_SWITCH_ON_KEY, &entry.switch_on, 1) ||
+                !flipper_format_read_uint32(
+                    ff, AC_DEVICE_STATE_STEPS_SENT_KEY, &entry.steps_sent, 1))) {
+                break;
+            }
+
+            if(furi_string_equal(tmp, name)) {
+                *state = entry;
+                found = true;
+            }
+        }
+    } while(false);
+
+    furi_string_free(tmp);
+    flipper_format_free(ff);
+    furi_record_close(RECORD_STORAGE);
+
+    return found;
+}
+
+const char* ac_device_get_name(const AcDevice* device) {
+    return device->config.name;
+}
+
+bool ac_device_is_on(const AcDevice* device) {
+    return device->is_on;
+}
+
+uint32_t ac_device_get_remaining_time(const AcDevice* device) {
+    if(device->event == AC_SCHEDULER_ID_NONE) {
+        return 0;
+    }
+
+    const int32_t remaining = (int32_t)(device->deadline - furi_get_tick());
+    return remaining > 0 ? (uint32_t)remaining : 0;
+}
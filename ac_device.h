@@ -0,0 +1,231 @@
+/**
+ * @file ac_device.h
+ * @brief A/C unit switched on and off on a cycle.
+ *
+ * Every device has its own remote, sequences and timing: it is turned on, kept on
+ * for on_ms, turned off, kept off for off_ms, and so on. The first sequence starts
+ * offset_ms after the device, so that several units can be cycled out of phase.
+ *
+ * The cycle is laid out on RTC time from the moment the device is started, so it stays
+ * aligned to the clock regardless of how long sequences take. Switches missed while
+ * the app was busy or asleep are skipped: the unit is brought straight to the state
+ * it should be in now, and the cycle carries on from there.
+ *
+ * Devices only queue their signals on a shared TX worker, which sends them one at a
+ * time, so transmissions for different units never overlap.
+ *
+ * Devices may be listed in a devices file:
+ *
+ * @code
+ * Filetype: AC devices file
+ * Version: 2
+ * #
+ * name: Bedroom
+ * remote: /ext/infrared/Bedroom.ir
+ * on_minutes: 60
+ * off_minutes: 180
+ * offset_minutes: 0
+ * verify: gpio PA7
+ * @endcode
+ *
+ * Each device lists all six keys, in this order. Version 1 files have no verify key
+ * and no verification. Sequences are loaded from the .seq file next to the remote,
+ * see ac_sequence.h.
+ *
+ * With verification (see ac_verifier.h), a switch is only complete once it has been
+ * confirmed. Otherwise its sequence is sent again after a backoff, a bounded number
+ * of times, after which the unit is assumed to have switched anyway. As retries
+ * resend the whole sequence, they are only made when the turn-on and turn-off
+ * sequences have no signal in common, or with a sensor showing the unit still in
+ * the other state right before the resend. Otherwise, e.g. for a toggling Power
+ * button acknowledged over infrared, an unconfirmed switch is only reported.
+ *
+ * The state of the devices can be saved whenever it changes and restored when the
+ * app starts again, so that a restart neither sends anything nor resets the cycle.
+ * A state file lists, for each device by name, the on and off times it was saved
+ * with, whether the unit is on, the RTC timestamp and state of its next switch, and
+ * how far the switch in progress got, if any, down to the steps of its sequence sent.
+ */
+#pragma once
+
+#include "ac_scheduler.h"
+#include "ac_tx_worker.h"
+#include "ac_verifier.h"
+
+#define AC_DEVICE_NAME_SIZE 32
+#define AC_DEVICE_PATH_SIZE 128
+
+/**
+ * @brief Device configuration.
+ */
+typedef struct {
+    char name[AC_DEVICE_NAME_SIZE]; /**< Name shown on-screen. */
+    char remote_path[AC_DEVICE_PATH_SIZE]; /**< Path to the .ir file of the unit. */
+    uint32_t on_ms; /**< Time the unit is kept on, in milliseconds. */
+    uint32_t off_ms; /**< Time the unit is kept off, in milliseconds. */
+    uint32_t offset_ms; /**< Time before the unit is first turned on, in milliseconds. */
+    AcVerifyMode verify_mode; /**< How switches are confirmed. */
+    const GpioPin* verify_pin; /**< Sensor pin for AcVerifyModeGpio, NULL otherwise. */
+} AcDeviceConfig;
+
+/**
+ * @brief Device state, as saved to and restored from a state file.
+ */
+typedef struct {
+    uint32_t on_ms; /**< Time the unit is kept on, to check the configuration still matches. */
+    uint32_t off_ms; /**< Time the unit is kept off, to check the configuration still matches. */
+    uint32_t target; /**< RTC timestamp of the next switch. */
+    bool target_on; /**< Whether the next switch turns the unit on. */
+    bool is_on; /**< Whether the unit is on, as of the last completed switch. */
+    bool switching; /**< Whether a switch was in progress. */
+    bool switch_on; /**< Whether that switch turns the unit on. */
+    uint32_t steps_sent; /**< Steps of its sequence already sent. */
+} AcDeviceState;
+
+/**
+ * @brief AcDevice opaque type declaration.
+ */
+typedef struct AcDevice AcDevice;
+
+/**
+ * @brief Callback invoked whenever a device sends a step, starts verifying a switch or
+ * changes state.
+ */
+typedef void (*AcDeviceChangedCallback)(AcDevice* device, void* context);
+
+/**
+ * @brief Load device configurations from a devices file.
+ *
+ * @param[in] path pointer to a zero-terminated string containing the file path.
+ * @param[out] configs pointer to an array to hold the configurations.
+ * @param[in] max_count number of elements in the configs array.
+ * @returns number of configurations loaded, 0 if the file is missing or invalid.
+ */
+size_t ac_device_config_load(const char* path, AcDeviceConfig* configs, size_t max_count);
+
+/**
+ * @brief Create a new AcDevice instance.
+ *
+ * @param[in] config pointer to the device configuration, copied into the instance.
+ * @param[in,out] scheduler pointer to the scheduler to run the device from.
+ * @param[in,out] tx_worker pointer to the worker to queue signals on.
+ * @param[in] changed_callback callback to report changes, may be NULL.
+ * @param[in,out] context pointer to a user-specified object passed to the callback.
+ * @returns pointer to the instance created.
+ */
+AcDevice* ac_device_alloc(
+    const AcDeviceConfig* config,
+    AcScheduler* scheduler,
+    AcTxWorker* tx_worker,
+    AcDeviceChangedCallback changed_callback,
+    void* context);
+
+/**
+ * @brief Delete an AcDevice instance, cancelling anything it has scheduled.
+ *
+ * The TX worker must not hold any of its signals anymore, i.e. be stopped first.
+ *
+ * @param[in,out] device pointer to the instance to be deleted.
+ */
+void ac_device_free(AcDevice* device);
+
+/**
+ * @brief Load the remote and sequences of a device.
+ *
+ * Only touches the device itself, so it may be called from another thread as long
+ * as the device has not been started.
+ *
+ * @param[in,out] device pointer to the instance to be loaded.
+ * @returns true if the remote was loaded, false otherwise.
+ */
+bool ac_device_load(AcDevice* device);
+
+/**
+ * @brief Test whether the remote of a device has been loaded.
+ *
+ * @param[in] device pointer to the instance to be tested.
+ * @returns true if the device is loaded, false otherwise.
+ */
+bool ac_device_is_loaded(const AcDevice* device);
+
+/**
+ * @brief Start cycling a loaded device, beginning with turning it on after its offset.
+ *
+ * @param[in,out] device pointer to the instance to be started.
+ */
+void ac_device_start(AcDevice* device);
+
+/**
+ * @brief Resume cycling a loaded device from a saved state.
+ *
+ * Switches missed since the state was saved are caught up on as described above; if
+ * the unit is already in the state it should be in now, nothing is sent. A switch that
+ * was in progress is finished first, from the step it was left at, so that the steps
+ * already sent are not sent again (which would undo them with a toggling button).
+ *
+ * @param[in,out] device pointer to the instance to be resumed.
+ * @param[in] state pointer to the state to be resumed from.
+ * @returns true if the device was resumed, false if the state doesn't match its
+ *          configuration or the clock, in which case it should be started instead.
+ */
+bool ac_device_resume(AcDevice* device, const AcDeviceState* state);
+
+/**
+ * @brief Get the state of a device, including how far the switch in progress got.
+ *
+ * @param[in] device pointer to the instance to be queried.
+ * @param[out] state pointer to the state to be filled in.
+ */
+void ac_device_get_state(const AcDevice* device, AcDeviceState* state);
+
+/**
+ * @brief Test whether a device is switching state, i.e. sending or confirming a switch.
+ *
+ * @param[in] device pointer to the instance to be tested.
+ * @returns true if a switch is in progress, false otherwise.
+ */
+bool ac_device_is_switching(const AcDevice* device);
+
+/**
+ * @brief Save the state of devices to a state file, replacing it.
+ *
+ * @param[in] path pointer to a zero-terminated string containing the file path.
+ * @param[in] devices pointer to an array of started devices.
+ * @param[in] count number of elements in the devices array.
+ * @returns true if the file was written, false otherwise.
+ */
+bool ac_device_state_save(const char* path, AcDevice* const* devices, size_t count);
+
+/**
+ * @brief Load the state of a device from a state file.
+ *
+ * @param[in] path pointer to a zero-terminated string containing the file path.
+ * @param[in] name pointer to a zero-terminated string containing the device name.
+ * @param[out] state pointer to the state to be filled in.
+ * @returns true if the device was found in the file, false otherwise.
+ */
+bool ac_device_state_load(const char* path, const char* name, AcDeviceState* state);
+
+/**
+ * @brief Get the name of a device.
+ *
+ * @param[in] device pointer to the instance to be queried.
+ * @returns pointer to a zero-terminated string owned by the device.
+ */
+const char* ac_device_get_name(const AcDevice* device);
+
+/**
+ * @brief Test whether a device should currently be on.
+ *
+ * @param[in] device pointer to the instance to be tested.
+ * @returns true if the last completed sequence turned the unit on, false otherwise.
+ */
+bool ac_device_is_on(const AcDevice* device);
+
+/**
+ * @brief Get the time left until a device starts its next sequence.
+ *
+ * @param[in] device pointer to the instance to be queried.
+ * @returns time left in milliseconds, 0 if a sequence is running or due.
+ */
+uint32_t ac_device_get_remaining_time(const AcDevice* device);
@@ -0,0 +1,190 @@
+#include "ac_remote.h"
+#include "ac_remote_cache.h"
+
+#include <furi.h>
+#include <storage/storage.h>
+
+#define TAG "AcRemote"
+
+#define AC_REMOTE_FILE_TYPE "IR signals file"
+#define AC_REMOTE_FILE_VERSION 1
+#define AC_REMOTE_CACHE_DIR APP_DATA_PATH("cache")
+#define AC_REMOTE_CACHE_SUFFIX ".bin"
+
+struct AcRemote {
+    Storage* storage;
+    AcRemoteCache* cache; // Used when the binary cache is up to date.
+    FlipperFormat* ff; // Used otherwise, along with the index.
+    InfraredSignalIndex* index;
+    InfraredSignal** signals; // Parsed on first use, NULL until then.
+    size_t count;
+    bool canonicalize; // Whether raw signals are decoded where possible.
+};
+
+AcRemote* ac_remote_alloc(void) {
+    AcRemote* remote = malloc(sizeof(AcRemote));
+
+    remote->storage = furi_record_open(RECORD_STORAGE);
+    remote->cache = NULL;
+    remote->ff = NULL;
+    remote->index = infrared_signal_index_alloc();
+    remote->signals = NULL;
+    remote->count = 0;
+    remote->canonicalize = false;
+
+    return remote;
+}
+
+void ac_remote_free(AcRemote* remote) {
+    for(size_t i = 0; i < remote->count; ++i) {
+        if(remote->signals[i]) {
+            infrared_signal_free(remote->signals[i]);
+        }
+    }
+    free(remote->signals);
+    infrared_signal_index_free(remote->index);
+
+    if(remote->cache) {
+        ac_remote_cache_free(remote->cache);
+    }
+    if(remote->ff) {
+        flipper_format_free(remote->ff);
+    }
+
+    furi_record_close(RECORD_STORAGE);
+    free(remote);
+}
+
+static bool ac_remote_load_text(AcRemote* remote, const char* path) {
+    FlipperFormat* ff = flipper_format_file_alloc(remote->storage);
+    FuriString* tmp = furi_string_alloc();
+    bool success = false;
+
+    do {
+        if(!flipper_format_file_open_existing(ff, path)) break;
+
+        uint32_t version;
+        if(!flipper_format_read_header(ff, tmp, &version)) break;
+        if(!furi_string_equal(tmp, AC_REMOTE_FILE_TYPE) || version != AC_REMOTE_FILE_VERSION) {
+            FURI_LOG_E(TAG, "Unsupported file: %s", path);
+            break;
+        }
+
+        remote->count = infrared_signal_index_build(remote->index, ff);
+        success = true;
+    } while(false);
+
+    furi_string_free(tmp);
+
+    if(success) {
+        remote->ff = ff;
+    } else {
+        flipper_format_free(ff);
+    }
+
+    return success;
+}
+
+// Caches live in the app data folder, named after the source file. A hash of its full
+// path keeps remotes with the same name in different folders apart.
+static FuriString* ac_remote_get_cache_path(const char* path) {
+    const uint32_t hash = infrared_signal_hash(path, strlen(path));
+
+    const char* file_name = strrchr(path, '/');
+    file_name = file_name ? file_name + 1 : path;
+
+    return furi_string_alloc_printf(
+        "%s/%s.%08lX%s", AC_REMOTE_CACHE_DIR, file_name, hash, AC_REMOTE_CACHE_SUFFIX);
+}
+
+bool ac_remote_load(AcRemote* remote, const char* path) {
+    furi_assert(remote->cache == NULL && remote->ff == NULL);
+
+    if(!storage_file_exists(remote->storage, path)) {
+        return false;
+    }
+
+    storage_simply_mkdir(remote->storage, AC_REMOTE_CACHE_DIR);
+    FuriString* cache_path = ac_remote_get_cache_path(path);
+
+    // The binary cache is (re)generated from the .ir file whenever it is missing or stale.
+    const char* cache_file = furi_string_get_cstr(cache_path);
+    remote->cache = ac_remote_cache_open(remote->storage, cache_file, path, remote->canonicalize);
+    if(!remote->cache &&
+       ac_remote_cache_generate(remote->storage, cache_file, path, remote->canonicalize)) {
+        remote->cache =
+            ac_remote_cache_open(remote->storage, cache_file, path, remote->canonicalize);
+    }
+
+    furi_string_free(cache_path);
+
+    bool success = true;
+    if(remote->cache) {
+        remote->count = ac_remote_cache_get_count(remote->cache);
+    } else {
+        success = ac_remote_load_text(remote, path);
+    }
+
+    if(success) {
+        remote->signals = calloc(remote->count, sizeof(InfraredSignal*));
+        FURI_LOG_I(
+            TAG,
+            "Loaded %zu signals from %s%s",
+            remote->count,
+            path,
+            remote->cache ? " (cached)" : "");
+    }
+
+    return success;
+}
+
+void ac_remote_set_canonicalize(AcRemote* remote, bool canonicalize) {
+    furi_assert(remote->cache == NULL && remote->ff == NULL);
+    remote->canonicalize = canonicalize;
+}
+
+size_t ac_remote_get_count(const AcRemote* remote) {
+    return remote->count;
+}
+
+static bool ac_remote_search_by_name(AcRemote* remote, const char* name, size_t* signal_index) {
+    return remote->cache ?
+               ac_remote_cache_search_by_name(remote->cache, name, signal_index) :
+               infrared_signal_index_search_by_name(remote->index, remote->ff, name, signal_index);
+}
+
+static bool ac_remote_read(AcRemote* remote, InfraredSignal* signal, size_t signal_index) {
+    return remote->cache ?
+               ac_remote_cache_read(remote->cache, signal, signal_index) :
+               infrared_signal_index_read_by_index(remote->index, signal, remote->ff, signal_index);
+}
+
+const InfraredSignal* ac_remote_get_signal(AcRemote* remote, const char* name) {
+    size_t i;
+    if(!ac_remote_search_by_name(remote, name, &i)) {
+        FURI_LOG_E(TAG, "No signal named %s", name);
+        return NULL;
+    }
+
+    if(!remote->signals[i]) {
+        InfraredSignal* signal = infrared_signal_alloc();
+        if(!ac_remote_read(remote, signal, i)) {
+            FURI_LOG_E(TAG, "Failed to read signal %s", name);
+            infrared_signal_free(signal);
+            return NULL;
+        }
+
+        // Signals from the cache have been decoded already, if at all.
+        if(remote->canonicalize && !remote->cache) {
+            infrared_signal_canonicalize(signal);
+        }
+
+        // Encode parsed signals now so the transmit path doesn't have to next time,
+        // while raw ones are kept in compact form so more of them fit in memory.
+        infrared_signal_compile(signal);
+        infrared_signal_compact(signal);
+        remote->signals[i] = signal;
+    }
+
+    return remote->signals[i];
+}
@@ -0,0 +1,73 @@
+/**
+ * @file ac_remote.h
+ * @brief A/C remote loaded from an .ir file.
+ *
+ * Only signal names are read when the remote is loaded. Signal bodies are parsed
+ * (and compiled) the first time they are requested and kept for every later use.
+ *
+ * Signals are read from a binary cache in the app data folder (see ac_remote_cache.h),
+ * which is generated on first load, so neither the assets nor the infrared folder are
+ * written to. The .ir file is read directly if no cache can be written.
+ */
+#pragma once
+
+#include "infrared_signal.h"
+
+/**
+ * @brief AcRemote opaque type declaration.
+ */
+typedef struct AcRemote AcRemote;
+
+/**
+ * @brief Create a new, empty AcRemote instance.
+ *
+ * @returns pointer to the instance created.
+ */
+AcRemote* ac_remote_alloc(void);
+
+/**
+ * @brief Delete an AcRemote instance along with every signal it has parsed.
+ *
+ * @param[in,out] remote pointer to the instance to be deleted.
+ */
+void ac_remote_free(AcRemote* remote);
+
+/**
+ * @brief Load a remote from an .ir file.
+ *
+ * The file is kept open until the remote is deleted, so that signal bodies
+ * can be read on demand.
+ *
+ * @param[in,out] remote pointer to an empty instance to load into.
+ * @param[in] path pointer to a zero-terminated string containing the file path.
+ * @returns true if the file was opened and indexed, false otherwise.
+ */
+bool ac_remote_load(AcRemote* remote, const char* path);
+
+/**
+ * @brief Choose whether raw signals that decode cleanly are kept as parsed ones.
+ *
+ * See infrared_signal_canonicalize(). Disabled by default, and must be set before
+ * the remote is loaded. The binary cache is regenerated when this setting changes.
+ *
+ * @param[in,out] remote pointer to an empty instance.
+ * @param[in] canonicalize true to decode raw signals, false to keep them as they are.
+ */
+void ac_remote_set_canonicalize(AcRemote* remote, bool canonicalize);
+
+/**
+ * @brief Get the number of signals in a remote.
+ *
+ * @param[in] remote pointer to the instance to be queried.
+ * @returns number of signals in the remote.
+ */
+size_t ac_remote_get_count(const AcRemote* remote);
+
+/**
+ * @brief Get a signal by name, parsing it on first use.
+ *
+ * @param[in,out] remote pointer to the instance to be queried.
+ * @param[in] name pointer to a zero-terminated string containing the signal name.
+ * @returns pointer to the signal, or NULL if it is missing or could not be parsed.
+ */
+const InfraredSignal* ac_remote_get_signal(AcRemote* remote, const char* name);
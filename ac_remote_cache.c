@@ -0,0 +1,378 @@
+#include "ac_remote_cache.h"
+
+#include <furi.h>
+#include <infrared_worker.h>
+
+#define TAG "AcRemoteCache"
+
+#define AC_REMOTE_CACHE_MAGIC 0x52494341UL // "ACIR"
+#define AC_REMOTE_CACHE_VERSION 4
+#define AC_REMOTE_CACHE_NAME_SIZE 32
+
+#define AC_REMOTE_CACHE_FLAG_CANONICAL (1U << 0) // Raw signals were decoded where possible
+
+#define AC_REMOTE_SOURCE_FILE_TYPE "IR signals file"
+#define AC_REMOTE_SOURCE_FILE_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t flags;
+    uint32_t source_size;
+    uint32_t source_timestamp;
+    uint32_t records_offset;
+    uint32_t lookups_offset;
+    uint32_t count;
+} __attribute__((packed)) AcRemoteCacheHeader;
+
+typedef struct {
+    char name[AC_REMOTE_CACHE_NAME_SIZE]; // Zero-terminated.
+    uint8_t is_raw;
+    uint8_t reserved[3];
+    union {
+        struct {
+            int32_t protocol;
+            uint32_t address;
+            uint32_t command;
+        } message;
+        struct {
+            uint32_t frequency;
+            float duty_cycle;
+            uint32_t timings_offset; // Timings count followed by the timings themselves.
+        } raw;
+    } payload;
+} __attribute__((packed)) AcRemoteCacheRecord;
+
+typedef struct {
+    uint32_t name_hash;
+    uint32_t position; // Index of the record, i.e. of the signal in the source file.
+} __attribute__((packed)) AcRemoteCacheLookup;
+
+struct AcRemoteCache {
+    File* file;
+    uint32_t records_offset;
+    AcRemoteCacheLookup* lookups; // Sorted by name hash, then by position.
+    size_t count;
+};
+
+static int ac_remote_cache_lookup_compare(const void* a, const void* b) {
+    const AcRemoteCacheLookup* lhs = a;
+    const AcRemoteCacheLookup* rhs = b;
+
+    if(lhs->name_hash != rhs->name_hash) {
+        return lhs->name_hash < rhs->name_hash ? -1 : 1;
+    }
+    if(lhs->position != rhs->position) {
+        return lhs->position < rhs->position ? -1 : 1;
+    }
+    return 0;
+}
+
+static bool ac_remote_cache_get_source_info(
+    Storage* storage,
+    const char* source_path,
+    uint32_t* size,
+    uint32_t* timestamp) {
+    FileInfo info;
+    if(storage_common_stat(storage, source_path, &info) != FSE_OK) return false;
+    if(storage_common_timestamp(storage, source_path, timestamp) != FSE_OK) return false;
+
+    *size = (uint32_t)info.size;
+    return true;
+}
+
+static bool ac_remote_cache_write_signal(
+    File* file,
+    const InfraredSignal* signal,
+    const char* name,
+    AcRemoteCacheRecord* record) {
+    const size_t name_length = strlen(name);
+    if(name_length >= AC_REMOTE_CACHE_NAME_SIZE) {
+        FURI_LOG_E(TAG, "Signal name is too long: %s", name);
+        return false;
+    }
+
+    memset(record, 0, sizeof(AcRemoteCacheRecord));
+    memcpy(record->name, name, name_length);
+
+    if(infrared_signal_is_raw(signal)) {
+        const InfraredRawSignal* raw = infrared_signal_get_raw_signal(signal);
+        const uint32_t timings_size = raw->timings_size;
+        const size_t timings_bytes = timings_size * sizeof(uint32_t);
+
+        record->is_raw = 1;
+        record->payload.raw.frequency = raw->frequency;
+        record->payload.raw.duty_cycle = raw->duty_cycle;
+        record->payload.raw.timings_offset = storage_file_tell(file);
+
+        return storage_file_write(file, &timings_size, sizeof(timings_size)) ==
+                   sizeof(timings_size) &&
+               storage_file_write(file, raw->timings, timings_bytes) == timings_bytes;
+    } else {
+        const InfraredMessage* message = infrared_signal_get_message(signal);
+
+        record->payload.message.protocol = message->protocol;
+        record->payload.message.address = message->address;
+        record->payload.message.command = message->command;
+
+        return true;
+    }
+}
+
+bool ac_remote_cache_generate(
+    Storage* storage,
+    const char* cache_path,
+    const char* source_path,
+    bool canonicalize) {
+    uint32_t source_size, source_timestamp;
+    if(!ac_remote_cache_get_source_info(storage, source_path, &source_size, &source_timestamp)) {
+        return false;
+    }
+
+    AcRemoteCacheHeader header = {0};
+    header.source_size = source_size;
+    header.source_timestamp = source_timestamp;
+    header.flags = canonicalize ? AC_REMOTE_CACHE_FLAG_CANONICAL : 0;
+
+    FlipperFormat* ff = flipper_format_buffered_file_alloc(storage);
+    File* file = storage_file_alloc(storage);
+    FuriString* name = furi_string_alloc();
+    InfraredSignalLibrary* library = infrared_signal_library_alloc();
+
+    AcRemoteCacheRecord* records = NULL;
+    AcRemoteCacheLookup* lookups = NULL;
+    bool success = false;
+
+    do {
+        uint32_t version;
+        if(!flipper_format_buffered_file_open_existing(ff, source_path)) break;
+        if(!flipper_format_read_header(ff, name, &version)) break;
+        if(!furi_string_equal(name, AC_REMOTE_SOURCE_FILE_TYPE) ||
+           version != AC_REMOTE_SOURCE_FILE_VERSION) {
+            break;
+        }
+
+        // The whole source is loaded at once, into a single allocation.
+        if(!infrared_signal_library_load(library, ff)) break;
+
+        size_t invalid_index;
+        if(!infrared_signal_library_validate(library, &invalid_index)) {
+            FURI_LOG_E(
+                TAG,
+                "Invalid signal: %s",
+                infrared_signal_library_get_name(library, invalid_index));
+            break;
+        }
+
+        if(canonicalize) {
+            const size_t converted = infrared_signal_library_canonicalize(library);
+            FURI_LOG_I(TAG, "Decoded %zu raw signals", converted);
+        }
+
+        header.count = infrared_signal_library_get_count(library);
+        records = malloc(header.count * sizeof(AcRemoteCacheRecord));
+
+        if(!storage_file_open(file, cache_path, FSAM_WRITE, FSOM_CREATE_ALWAYS)) break;
+
+        // Placeholder header, it is only made valid once everything else is written.
+        if(storage_file_write(file, &header, sizeof(header)) != sizeof(header)) break;
+
+        bool signals_ok = true;
+        for(size_t i = 0; signals_ok && i < header.count; ++i) {
+            signals_ok = ac_remote_cache_write_signal(
+                file,
+                infrared_signal_library_get_signal(library, i),
+                infrared_signal_library_get_name(library, i),
+                &records[i]);
+        }
+        if(!signals_ok) break;
+
+        const size_t records_bytes = header.count * sizeof(AcRemoteCacheRecord);
+        header.records_offset = storage_file_tell(file);
+        if(storage_file_write(file, records, records_bytes) != records_bytes) break;
+
+        // Name hashes are sorted once here, so that lookups are a binary search.
+        lookups = malloc(header.count * sizeof(AcRemoteCacheLookup));
+        for(size_t i = 0; i < header.count; ++i) {
+            lookups[i].name_hash = infrared_signal_hash(records[i].name, strlen(records[i].name));
+            lookups[i].position = i;
+        }
+        qsort(lookups, header.count, sizeof(AcRemoteCacheLookup), ac_remote_cache_lookup_compare);
+
+        const size_t lookups_bytes = header.count * sizeof(AcRemoteCacheLookup);
+        header.lookups_offset = storage_file_tell(file);
+        if(storage_file_write(file, lookups, lookups_bytes) != lookups_bytes) break;
+
+        header.magic = AC_REMOTE_CACHE_MAGIC;
+        header.version = AC_REMOTE_CACHE_VERSION;
+        header.record_size = sizeof(AcRemoteCacheRecord);
+        if(!storage_file_seek(file, 0, true)) break;
+        if(storage_file_write(file, &header, sizeof(header)) != sizeof(header)) break;
+
+        success = true;
+    } while(false);
+
+    storage_file_close(file);
+    if(!success) {
+        FURI_LOG_E(TAG, "Failed to generate %s", cache_path);
+        storage_simply_remove(storage, cache_path);
+    } else {
+        FURI_LOG_I(TAG, "Cached %lu signals in %s", header.count, cache_path);
+    }
+
+    free(lookups);
+    free(records);
+    infrared_signal_library_free(library);
+    furi_string_free(name);
+    storage_file_free(file);
+    flipper_format_free(ff);
+
+    return success;
+}
+
+AcRemoteCache* ac_remote_cache_open(
+    Storage* storage,
+    const char* cache_path,
+    const char* source_path,
+    bool canonicalize) {
+    AcRemoteCache* cache = malloc(sizeof(AcRemoteCache));
+    cache->file = storage_file_alloc(storage);
+    cache->lookups = NULL;
+    cache->count = 0;
+
+    bool success = false;
+
+    do {
+        uint32_t source_size, source_timestamp;
+        if(!ac_remote_cache_get_source_info(storage, source_path, &source_size, &source_timestamp))
+            break;
+        if(!storage_file_open(cache->file, cache_path, FSAM_READ, FSOM_OPEN_EXISTING)) break;
+
+        AcRemoteCacheHeader header;
+        if(storage_file_read(cache->file, &header, sizeof(header)) != sizeof(header)) break;
+        if(header.magic != AC_REMOTE_CACHE_MAGIC || header.version != AC_REMOTE_CACHE_VERSION ||
+           header.record_size != sizeof(AcRemoteCacheRecord)) {
+            FURI_LOG_W(TAG, "Unsupported cache file: %s", cache_path);
+            break;
+        }
+        if(header.source_size != source_size || header.source_timestamp != source_timestamp ||
+           header.flags != (canonicalize ? AC_REMOTE_CACHE_FLAG_CANONICAL : 0)) {
+            FURI_LOG_I(TAG, "Cache is stale: %s", cache_path);
+            break;
+        }
+
+        if(!storage_file_seek(cache->file, header.lookups_offset, true)) break;
+
+        // Only the lookup table stays in memory, records are fetched on demand.
+        const size_t lookups_bytes = header.count * sizeof(AcRemoteCacheLookup);
+        cache->lookups = malloc(lookups_bytes);
+        if(storage_file_read(cache->file, cache->lookups, lookups_bytes) != lookups_bytes) break;
+
+        bool lookups_ok = true;
+        for(size_t i = 0; lookups_ok && i < header.count; ++i) {
+            lookups_ok = cache->lookups[i].position < header.count;
+        }
+        if(!lookups_ok) break;
+
+        cache->records_offset = header.records_offset;
+        cache->count = header.count;
+        success = true;
+    } while(false);
+
+    if(!success) {
+        ac_remote_cache_free(cache);
+        cache = NULL;
+    }
+
+    return cache;
+}
+
+void ac_remote_cache_free(AcRemoteCache* cache) {
+    storage_file_close(cache->file);
+    storage_file_free(cache->file);
+    free(cache->lookups);
+    free(cache);
+}
+
+size_t ac_remote_cache_get_count(const AcRemoteCache* cache) {
+    return cache->count;
+}
+
+static bool ac_remote_cache_read_record(
+    AcRemoteCache* cache,
+    size_t signal_index,
+    AcRemoteCacheRecord* record) {
+    const uint32_t offset = cache->records_offset + signal_index * sizeof(AcRemoteCacheRecord);
+    return storage_file_seek(cache->file, offset, true) &&
+           storage_file_read(cache->file, record, sizeof(AcRemoteCacheRecord)) ==
+               sizeof(AcRemoteCacheRecord);
+}
+
+bool ac_remote_cache_search_by_name(AcRemoteCache* cache, const char* name, size_t* signal_index) {
+    const uint32_t name_hash = infrared_signal_hash(name, strlen(name));
+
+    // Lower bound by hash, so that the first signal in the file wins on duplicate names.
+    size_t lo = 0;
+    size_t hi = cache->count;
+
+    while(lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if(cache->lookups[mid].name_hash < name_hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    // Hashes may collide, so candidates are confirmed by reading their record back.
+    AcRemoteCacheRecord record;
+
+    for(; lo < cache->count && cache->lookups[lo].name_hash == name_hash; ++lo) {
+        const size_t position = cache->lookups[lo].position;
+        if(!ac_remote_cache_read_record(cache, position, &record)) return false;
+
+        record.name[AC_REMOTE_CACHE_NAME_SIZE - 1] = '\0';
+        if(strcmp(record.name, name) == 0) {
+            *signal_index = position;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool ac_remote_cache_read(AcRemoteCache* cache, InfraredSignal* signal, size_t signal_index) {
+    if(signal_index >= cache->count) return false;
+
+    AcRemoteCacheRecord record;
+    if(!ac_remote_cache_read_record(cache, signal_index, &record)) return false;
+
+    if(!record.is_raw) {
+        InfraredMessage message = {
+            .protocol = record.payload.message.protocol,
+            .address = record.payload.message.address,
+            .command = record.payload.message.command,
+            .repeat = false,
+        };
+        infrared_signal_set_message(signal, &message);
+        return infrared_signal_is_valid(signal);
+    }
+
+    uint32_t timings_size;
+    if(!storage_file_seek(cache->file, record.payload.raw.timings_offset, true)) return false;
+    if(storage_file_read(cache->file, &timings_size, sizeof(timings_size)) != sizeof(timings_size))
+        return false;
+    if(timings_size > MAX_TIMINGS_AMOUNT) return false;
+
+    const size_t timings_bytes = timings_size * sizeof(uint32_t);
+    uint32_t* timings = malloc(timings_bytes);
+    if(storage_file_read(cache->file, timings, timings_bytes) != timings_bytes) {
+        free(timings);
+        return false;
+    }
+
+    infrared_signal_adopt_raw_signal(
+        signal, timings, timings_size, record.payload.raw.frequency, record.payload.raw.duty_cycle);
+    return infrared_signal_is_valid(signal);
+}
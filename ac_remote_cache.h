@@ -0,0 +1,92 @@
+/**
+ * @file ac_remote_cache.h
+ * @brief Binary sidecar cache for .ir files.
+ *
+ * A cache file holds every signal of its source .ir file in a packed binary form:
+ * a header, length-prefixed raw timing blocks, a table of fixed-size records,
+ * one per signal, and a lookup table of name hashes sorted for binary search.
+ * The header stores the size and modification time of the source file, so that
+ * a stale cache is detected and regenerated.
+ *
+ * Opening a cache reads the lookup table only, in one go. Finding a signal by name
+ * then reads just the records whose name hash matches, parsed signals are built
+ * straight from their records, raw ones with one more seek and read.
+ */
+#pragma once
+
+#include <storage/storage.h>
+#include "infrared_signal.h"
+
+/**
+ * @brief AcRemoteCache opaque type declaration.
+ */
+typedef struct AcRemoteCache AcRemoteCache;
+
+/**
+ * @brief Write a cache file for an .ir file, replacing any previous one.
+ *
+ * Every signal in the source file is parsed. Generation fails if any of them
+ * can not be read or has a name too long to be cached.
+ *
+ * @param[in,out] storage pointer to the Storage record instance.
+ * @param[in] cache_path pointer to a zero-terminated string containing the cache file path.
+ * @param[in] source_path pointer to a zero-terminated string containing the .ir file path.
+ * @param[in] canonicalize whether to store raw signals that decode cleanly as parsed ones,
+ *            see infrared_signal_canonicalize().
+ * @returns true if the cache was successfully written, false otherwise.
+ */
+bool ac_remote_cache_generate(
+    Storage* storage,
+    const char* cache_path,
+    const char* source_path,
+    bool canonicalize);
+
+/**
+ * @brief Open a cache file.
+ *
+ * @param[in,out] storage pointer to the Storage record instance.
+ * @param[in] cache_path pointer to a zero-terminated string containing the cache file path.
+ * @param[in] source_path pointer to a zero-terminated string containing the .ir file path.
+ * @param[in] canonicalize whether the cache must have been generated with canonicalization.
+ * @returns pointer to the instance created, or NULL if the cache is missing, corrupt or stale.
+ */
+AcRemoteCache* ac_remote_cache_open(
+    Storage* storage,
+    const char* cache_path,
+    const char* source_path,
+    bool canonicalize);
+
+/**
+ * @brief Close a cache file and delete its instance.
+ *
+ * @param[in,out] cache pointer to the instance to be deleted.
+ */
+void ac_remote_cache_free(AcRemoteCache* cache);
+
+/**
+ * @brief Get the number of signals in a cache.
+ *
+ * @param[in] cache pointer to the instance to be queried.
+ * @returns number of signals in the cache.
+ */
+size_t ac_remote_cache_get_count(const AcRemoteCache* cache);
+
+/**
+ * @brief Find the index of a signal with a particular name.
+ *
+ * @param[in,out] cache pointer to the instance to be queried.
+ * @param[in] name pointer to a zero-terminated string containing the signal name.
+ * @param[out] signal_index pointer to the variable to hold the signal index.
+ * @returns true if the signal was found, false otherwise.
+ */
+bool ac_remote_cache_search_by_name(AcRemoteCache* cache, const char* name, size_t* signal_index);
+
+/**
+ * @brief Read a signal with a particular index from a cache.
+ *
+ * @param[in,out] cache pointer to the instance to be read from.
+ * @param[in,out] signal pointer to the instance to be read into.
+ * @param[in] signal_index the requested signal index.
+ * @returns true if the signal was successfully read, false otherwise.
+ */
+bool ac_remote_cache_read(AcRemoteCache* cache, InfraredSignal* signal, size_t signal_index);
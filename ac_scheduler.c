@@ -0,0 +1,150 @@
+#include "ac_scheduler.h"
+#include "ac_stats.h"
+
+#include <furi.h>
+
+#define AC_SCHEDULER_INITIAL_CAPACITY 8
+
+typedef struct {
+    uint32_t deadline;
+    AcSchedulerId id; // Increasing, breaks ties between equal deadlines.
+    AcSchedulerCallback callback;
+    void* context;
+} AcSchedulerEvent;
+
+struct AcScheduler {
+    AcSchedulerEvent* heap;
+    size_t count;
+    size_t capacity;
+    AcSchedulerId next_id;
+};
+
+static bool ac_scheduler_event_before(const AcSchedulerEvent* lhs, const AcSchedulerEvent* rhs) {
+    const int32_t difference = (int32_t)(lhs->deadline - rhs->deadline);
+    return difference != 0 ? difference < 0 : (int32_t)(lhs->id - rhs->id) < 0;
+}
+
+static void ac_scheduler_swap(AcScheduler* scheduler, size_t a, size_t b) {
+    const AcSchedulerEvent event = scheduler->heap[a];
+    scheduler->heap[a] = scheduler->heap[b];
+    scheduler->heap[b] = event;
+}
+
+static void ac_scheduler_sift_up(AcScheduler* scheduler, size_t index) {
+    while(index > 0) {
+        const size_t parent = (index - 1) / 2;
+        if(!ac_scheduler_event_before(&scheduler->heap[index], &scheduler->heap[parent])) break;
+
+        ac_scheduler_swap(scheduler, index, parent);
+        index = parent;
+    }
+}
+
+static void ac_scheduler_sift_down(AcScheduler* scheduler, size_t index) {
+    while(true) {
+        const size_t left = index * 2 + 1;
+        const size_t right = left + 1;
+        size_t first = index;
+
+        if(left < scheduler->count &&
+           ac_scheduler_event_before(&scheduler->heap[left], &scheduler->heap[first])) {
+            first = left;
+        }
+        if(right < scheduler->count &&
+           ac_scheduler_event_before(&scheduler->heap[right], &scheduler->heap[first])) {
+            first = right;
+        }
+        if(first == index) break;
+
+        ac_scheduler_swap(scheduler, index, first);
+        index = first;
+    }
+}
+
+static void ac_scheduler_remove(AcScheduler* scheduler, size_t index) {
+    scheduler->heap[index] = scheduler->heap[--scheduler->count];
+
+    if(index < scheduler->count) {
+        ac_scheduler_sift_up(scheduler, index);
+        ac_scheduler_sift_down(scheduler, index);
+    }
+}
+
+AcScheduler* ac_scheduler_alloc(void) {
+    AcScheduler* scheduler = malloc(sizeof(AcScheduler));
+
+    scheduler->heap = malloc(AC_SCHEDULER_INITIAL_CAPACITY * sizeof(AcSchedulerEvent));
+    scheduler->count = 0;
+    scheduler->capacity = AC_SCHEDULER_INITIAL_CAPACITY;
+    scheduler->next_id = AC_SCHEDULER_ID_NONE + 1;
+
+    return scheduler;
+}
+
+void ac_scheduler_free(AcScheduler* scheduler) {
+    free(scheduler->heap);
+    free(scheduler);
+}
+
+AcSchedulerId ac_scheduler_add(
+    AcScheduler* scheduler,
+    uint32_t deadline,
+    AcSchedulerCallback callback,
+    void* context) {
+    furi_assert(callback);
+
+    if(scheduler->count == scheduler->capacity) {
+        scheduler->capacity *= 2;
+        scheduler->heap =
+            realloc(scheduler->heap, scheduler->capacity * sizeof(AcSchedulerEvent));
+    }
+
+    const AcSchedulerId id = scheduler->next_id++;
+    if(scheduler->next_id == AC_SCHEDULER_ID_NONE) {
+        scheduler->next_id++;
+    }
+
+    AcSchedulerEvent* event = &scheduler->heap[scheduler->count];
+    event->deadline = deadline;
+    event->id = id;
+    event->callback = callback;
+    event->context = context;
+
+    ac_scheduler_sift_up(scheduler, scheduler->count++);
+
+    return id;
+}
+
+bool ac_scheduler_cancel(AcScheduler* scheduler, AcSchedulerId id) {
+    if(id == AC_SCHEDULER_ID_NONE) return false;
+
+    for(size_t i = 0; i < scheduler->count; ++i) {
+        if(scheduler->heap[i].id == id) {
+            ac_scheduler_remove(scheduler, i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+uint32_t ac_scheduler_get_timeout(const AcScheduler* scheduler) {
+    if(scheduler->count == 0) {
+        return FuriWaitForever;
+    }
+
+    const int32_t wait = (int32_t)(scheduler->heap[0].deadline - furi_get_tick());
+    return wait > 0 ? (uint32_t)wait : 0;
+}
+
+void ac_scheduler_dispatch(AcScheduler* scheduler) {
+    while(ac_scheduler_get_timeout(scheduler) == 0) {
+        // The event is taken off the heap first, so its callback may schedule again.
+        const AcSchedulerEvent event = scheduler->heap[0];
+        ac_scheduler_remove(scheduler, 0);
+
+        ac_stats_record(AcStatsIdDispatchLateness, furi_get_tick() - event.deadline);
+
+        event.callback(event.context);
+    }
+}
@@ -0,0 +1,94 @@
+/**
+ * @file ac_scheduler.h
+ * @brief Deadline scheduler for the app event loop.
+ *
+ * Events are kept in a min-heap ordered by deadline, so any number of them can be
+ * pending without one OS timer each. Nothing runs on its own: the thread owning the
+ * scheduler waits for at most ac_scheduler_get_timeout() and then calls
+ * ac_scheduler_dispatch(), so every callback runs on that thread.
+ *
+ * Deadlines are system ticks and are compared with wraparound, so they must be
+ * less than half the tick range away.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Identifier of a scheduled event, AC_SCHEDULER_ID_NONE if none.
+ */
+typedef uint32_t AcSchedulerId;
+
+#define AC_SCHEDULER_ID_NONE 0
+
+/**
+ * @brief AcScheduler opaque type declaration.
+ */
+typedef struct AcScheduler AcScheduler;
+
+/**
+ * @brief Callback invoked once the deadline of an event has passed.
+ */
+typedef void (*AcSchedulerCallback)(void* context);
+
+/**
+ * @brief Create a new, empty AcScheduler instance.
+ *
+ * @returns pointer to the instance created.
+ */
+AcScheduler* ac_scheduler_alloc(void);
+
+/**
+ * @brief Delete an AcScheduler instance. Pending events are dropped.
+ *
+ * @param[in,out] scheduler pointer to the instance to be deleted.
+ */
+void ac_scheduler_free(AcScheduler* scheduler);
+
+/**
+ * @brief Schedule an event.
+ *
+ * Events with the same deadline are dispatched in the order they were added.
+ *
+ * @param[in,out] scheduler pointer to the instance to be used.
+ * @param[in] deadline tick at which the callback is due.
+ * @param[in] callback callback to be invoked.
+ * @param[in,out] context pointer to a user-specified object passed to the callback.
+ * @returns identifier of the event, to be passed to ac_scheduler_cancel().
+ */
+AcSchedulerId ac_scheduler_add(
+    AcScheduler* scheduler,
+    uint32_t deadline,
+    AcSchedulerCallback callback,
+    void* context);
+
+/**
+ * @brief Cancel a pending event.
+ *
+ * Has no effect if the event has already been dispatched or cancelled.
+ *
+ * @param[in,out] scheduler pointer to the instance to be used.
+ * @param[in] id identifier of the event, may be AC_SCHEDULER_ID_NONE.
+ * @returns true if the event was pending, false otherwise.
+ */
+bool ac_scheduler_cancel(AcScheduler* scheduler, AcSchedulerId id);
+
+/**
+ * @brief Get the time left until the earliest pending event is due.
+ *
+ * @param[in] scheduler pointer to the instance to be queried.
+ * @returns number of ticks to wait, 0 if an event is already due, or
+ *          FuriWaitForever if no event is pending.
+ */
+uint32_t ac_scheduler_get_timeout(const AcScheduler* scheduler);
+
+/**
+ * @brief Invoke the callbacks of all events that are due, earliest first.
+ *
+ * Callbacks may add and cancel events, including ones that are due right away.
+ *
+ * @param[in,out] scheduler pointer to the instance to be used.
+ */
+void ac_scheduler_dispatch(AcScheduler* scheduler);
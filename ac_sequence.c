@@ -0,0 +1,340 @@
+#include "ac_sequence.h"
+#include "ac_trace.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+
+#include <furi.h>
+#include <flipper_format/flipper_format.h>
+#include <storage/storage.h>
+
+#define TAG "AcSequence"
+
+#define AC_SEQUENCE_FILE_TYPE "AC sequence file"
+#define AC_SEQUENCE_FILE_VERSION 1
+
+#define AC_SEQUENCE_NAME_KEY "name"
+#define AC_SEQUENCE_STEPS_KEY "steps"
+#define AC_SEQUENCE_STEP_KEY "step"
+
+#define AC_SEQUENCE_MAX_STEPS 64
+#define AC_SEQUENCE_MAX_DELAY_MS 60000UL
+#define AC_SEQUENCE_MAX_REPEAT 100UL
+#define AC_SEQUENCE_HOLD_FLAG "hold"
+
+struct AcSequence {
+    char name[AC_SEQUENCE_NAME_SIZE];
+    AcSequenceStep* steps;
+    size_t steps_count;
+};
+
+struct AcSequenceSet {
+    AcSequence* sequences;
+    size_t count;
+};
+
+struct AcSequencer {
+    AcScheduler* scheduler;
+    AcSchedulerId event; // Pending step, AC_SCHEDULER_ID_NONE if none.
+    AcSequencerSendCallback send_callback;
+    AcSequencerDoneCallback done_callback;
+    void* context;
+
+    const AcSequence* sequence; // NULL when idle.
+    size_t step; // Step to be sent next.
+    uint32_t deadline; // Tick at which the next action is due.
+    uint32_t run; // Identifier of the running sequence.
+};
+
+static uint32_t sequencer_runs = 0; // Sequences started so far, by any sequencer.
+
+const char* ac_sequence_get_name(const AcSequence* sequence) {
+    return sequence->name;
+}
+
+size_t ac_sequence_get_steps_count(const AcSequence* sequence) {
+    return sequence->steps_count;
+}
+
+bool ac_sequence_shares_signal(const AcSequence* lhs, const AcSequence* rhs) {
+    for(size_t i = 0; i < lhs->steps_count; ++i) {
+        for(size_t j = 0; j < rhs->steps_count; ++j) {
+            if(strcmp(lhs->steps[i].signal, rhs->steps[j].signal) == 0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+AcSequenceSet* ac_sequence_set_alloc(void) {
+    AcSequenceSet* set = malloc(sizeof(AcSequenceSet));
+
+    set->sequences = NULL;
+    set->count = 0;
+
+    return set;
+}
+
+void ac_sequence_set_free(AcSequenceSet* set) {
+    for(size_t i = 0; i < set->count; ++i) {
+        free(set->sequences[i].steps);
+    }
+    free(set->sequences);
+    free(set);
+}
+
+bool ac_sequence_set_add(
+    AcSequenceSet* set,
+    const char* name,
+    const AcSequenceStep* steps,
+    size_t steps_count) {
+    if(strlen(name) >= AC_SEQUENCE_NAME_SIZE) {
+        FURI_LOG_E(TAG, "Sequence name is too long: %s", name);
+        return false;
+    }
+
+    AcSequence* sequence = (AcSequence*)ac_sequence_set_get(set, name);
+    if(sequence) {
+        free(sequence->steps);
+    } else {
+        set->sequences = realloc(set->sequences, (set->count + 1) * sizeof(AcSequence));
+        sequence = &set->sequences[set->count++];
+        strcpy(sequence->name, name);
+    }
+
+    sequence->steps = malloc(steps_count * sizeof(AcSequenceStep));
+    sequence->steps_count = steps_count;
+    memcpy(sequence->steps, steps, steps_count * sizeof(AcSequenceStep));
+
+    return true;
+}
+
+static const char* ac_sequence_skip_spaces(const char* cursor) {
+    while(isspace((unsigned char)*cursor)) {
+        ++cursor;
+    }
+    return cursor;
+}
+
+// Parse a whole decimal field no greater than max, moving the cursor past it.
+static bool ac_sequence_parse_number(const char** cursor, unsigned long max, uint32_t* value) {
+    // strtoul() would take a sign, so that "-1" wraps around, hence the digit check.
+    if(!isdigit((unsigned char)**cursor)) return false;
+
+    char* end;
+    const unsigned long number = strtoul(*cursor, &end, 10);
+    if(number > max || (*end != '\0' && !isspace((unsigned char)*end))) return false;
+
+    *value = number;
+    *cursor = end;
+    return true;
+}
+
+static bool ac_sequence_parse_step(const char* line, AcSequenceStep* step) {
+    bool success = false;
+
+    do {
+        const char* cursor = ac_sequence_skip_spaces(line);
+        const size_t name_length = strcspn(cursor, " \t");
+        if(name_length == 0 || name_length >= AC_SEQUENCE_NAME_SIZE) break;
+
+        memcpy(step->signal, cursor, name_length);
+        step->signal[name_length] = '\0';
+        cursor = ac_sequence_skip_spaces(cursor + name_length);
+
+        if(!ac_sequence_parse_number(&cursor, AC_SEQUENCE_MAX_DELAY_MS, &step->delay_ms)) break;
+        cursor = ac_sequence_skip_spaces(cursor);
+
+        step->repeat = 1;
+        if(isdigit((unsigned char)*cursor)) {
+            if(!ac_sequence_parse_number(&cursor, AC_SEQUENCE_MAX_REPEAT, &step->repeat) ||
+               step->repeat == 0) {
+                break;
+            }
+            cursor = ac_sequence_skip_spaces(cursor);
+        }
+
+        const size_t flag_length = strlen(AC_SEQUENCE_HOLD_FLAG);
+        step->hold = strncmp(cursor, AC_SEQUENCE_HOLD_FLAG, flag_length) == 0 &&
+                     (cursor[flag_length] == '\0' || isspace((unsigned char)cursor[flag_length]));
+        if(step->hold) {
+            cursor = ac_sequence_skip_spaces(cursor + flag_length);
+        }
+
+        success = *cursor == '\0';
+    } while(false);
+
+    if(!success) {
+        FURI_LOG_E(TAG, "Invalid step: %s", line);
+    }
+
+    return success;
+}
+
+bool ac_sequence_set_load(AcSequenceSet* set, const char* path) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    FlipperFormat* ff = flipper_format_buffered_file_alloc(storage);
+    FuriString* name = furi_string_alloc();
+    FuriString* line = furi_string_alloc();
+    AcSequenceStep* steps = malloc(AC_SEQUENCE_MAX_STEPS * sizeof(AcSequenceStep));
+    // Sequences are only merged into the set once the whole file has been read.
+    AcSequenceSet* loaded = ac_sequence_set_alloc();
+    bool success = false;
+
+    do {
+        if(!flipper_format_buffered_file_open_existing(ff, path)) break;
+
+        uint32_t version;
+        if(!flipper_format_read_header(ff, name, &version)) break;
+        if(!furi_string_equal(name, AC_SEQUENCE_FILE_TYPE) ||
+           version != AC_SEQUENCE_FILE_VERSION) {
+            FURI_LOG_E(TAG, "Unsupported file: %s", path);
+            break;
+        }
+
+        bool sequences_ok = true;
+        while(flipper_format_read_string(ff, AC_SEQUENCE_NAME_KEY, name)) {
+            uint32_t steps_count;
+            if(!flipper_format_read_uint32(ff, AC_SEQUENCE_STEPS_KEY, &steps_count, 1) ||
+               steps_count == 0 || steps_count > AC_SEQUENCE_MAX_STEPS) {
+                sequences_ok = false;
+                break;
+            }
+
+            for(uint32_t i = 0; i < steps_count && sequences_ok; ++i) {
+                sequences_ok = flipper_format_read_string(ff, AC_SEQUENCE_STEP_KEY, line) &&
+                               ac_sequence_parse_step(furi_string_get_cstr(line), &steps[i]);
+            }
+
+            if(!sequences_ok ||
+               !ac_sequence_set_add(loaded, furi_string_get_cstr(name), steps, steps_count)) {
+                sequences_ok = false;
+                break;
+            }
+        }
+        if(!sequences_ok) break;
+
+        // Names have been checked already, so none of these can fail.
+        for(size_t i = 0; i < loaded->count; ++i) {
+            const AcSequence* sequence = &loaded->sequences[i];
+            ac_sequence_set_add(set, sequence->name, sequence->steps, sequence->steps_count);
+        }
+
+        success = true;
+    } while(false);
+
+    if(!success) {
+        FURI_LOG_W(TAG, "Failed to load %s", path);
+    }
+
+    ac_sequence_set_free(loaded);
+    free(steps);
+    furi_string_free(line);
+    furi_string_free(name);
+    flipper_format_free(ff);
+    furi_record_close(RECORD_STORAGE);
+
+    return success;
+}
+
+const AcSequence* ac_sequence_set_get(const AcSequenceSet* set, const char* name) {
+    for(size_t i = 0; i < set->count; ++i) {
+        if(strcmp(set->sequences[i].name, name) == 0) {
+            return &set->sequences[i];
+        }
+    }
+    return NULL;
+}
+
+static void ac_sequencer_event_callback(void* context);
+
+// Perform every action that is due, then schedule the next one.
+static void ac_sequencer_run(AcSequencer* sequencer) {
+    while(sequencer->sequence) {
+        const int32_t wait = (int32_t)(sequencer->deadline - furi_get_tick());
+        if(wait > 0) {
+            sequencer->event = ac_scheduler_add(
+                sequencer->scheduler, sequencer->deadline, ac_sequencer_event_callback, sequencer);
+            return;
+        }
+
+        const AcSequence* sequence = sequencer->sequence;
+        if(sequencer->step == sequence->steps_count) {
+            sequencer->sequence = NULL;
+            if(sequencer->done_callback) {
+                sequencer->done_callback(sequence, sequencer->context);
+            }
+            return;
+        }
+
+        const AcSequenceStep* step = &sequence->steps[sequencer->step++];
+        sequencer->send_callback(step, sequencer->deadline, sequencer->run, sequencer->context);
+        sequencer->deadline += step->hold ? step->delay_ms : step->delay_ms * step->repeat;
+    }
+}
+
+static void ac_sequencer_event_callback(void* context) {
+    AcSequencer* sequencer = context;
+    sequencer->event = AC_SCHEDULER_ID_NONE;
+    ac_sequencer_run(sequencer);
+}
+
+AcSequencer* ac_sequencer_alloc(
+    AcScheduler* scheduler,
+    AcSequencerSendCallback send_callback,
+    AcSequencerDoneCallback done_callback,
+    void* context) {
+    furi_assert(send_callback);
+
+    AcSequencer* sequencer = malloc(sizeof(AcSequencer));
+
+    sequencer->scheduler = scheduler;
+    sequencer->event = AC_SCHEDULER_ID_NONE;
+    sequencer->send_callback = send_callback;
+    sequencer->done_callback = done_callback;
+    sequencer->context = context;
+    sequencer->sequence = NULL;
+
+    return sequencer;
+}
+
+void ac_sequencer_free(AcSequencer* sequencer) {
+    ac_sequencer_stop(sequencer);
+    free(sequencer);
+}
+
+void ac_sequencer_start(AcSequencer* sequencer, const AcSequence* sequence) {
+    ac_sequencer_start_at(sequencer, sequence, 0);
+}
+
+void ac_sequencer_start_at(AcSequencer* sequencer, const AcSequence* sequence, size_t step) {
+    furi_assert(step <= sequence->steps_count);
+    ac_sequencer_stop(sequencer);
+
+    ac_trace_record(AcTraceEventSequenceStart, sequence->steps_count, step);
+
+    sequencer->sequence = sequence;
+    sequencer->step = step;
+    sequencer->deadline = furi_get_tick();
+    if(++sequencer_runs == 0) {
+        sequencer_runs++;
+    }
+    sequencer->run = sequencer_runs;
+
+    ac_sequencer_run(sequencer);
+}
+
+void ac_sequencer_stop(AcSequencer* sequencer) {
+    ac_scheduler_cancel(sequencer->scheduler, sequencer->event);
+    sequencer->event = AC_SCHEDULER_ID_NONE;
+    sequencer->sequence = NULL;
+}
+
+bool ac_sequencer_is_running(const AcSequencer* sequencer) {
+    return sequencer->sequence != NULL;
+}
+
+size_t ac_sequencer_get_step(const AcSequencer* sequencer) {
+    return sequencer->sequence ? sequencer->step : 0;
+}
@@ -0,0 +1,241 @@
+/**
+ * @file ac_sequence.h
+ * @brief Data-driven signal sequences.
+ *
+ * A sequence is a list of steps, each sending a named signal a number of times and
+ * waiting a fixed delay after every transmission. Sequences can be defined in code
+ * or loaded from a sequence file:
+ *
+ * @code
+ * Filetype: AC sequence file
+ * Version: 1
+ * #
+ * name: Turn_on
+ * steps: 3
+ * step: Power 1000
+ * step: Mode 1000
+ * step: Mode 0
+ * @endcode
+ *
+ * Every step line holds the signal name, the delay in milliseconds (at most 60000) and
+ * an optional repeat count (1 to 100), which defaults to 1. Repeated transmissions of
+ * a step are handed over together, so that they can be sent as a single burst with the
+ * delay as gap.
+ *
+ * A step ending with "hold" is sent as if its button was held instead: the signal
+ * is followed by repeat - 1 protocol repeat frames, e.g. "step: Lower_temp 500 5 hold".
+ * Raw signals have no repeat frames and are sent repeat times in full, 150 ms apart.
+ * Its delay is waited once, after the whole held transmission.
+ *
+ * The sequencer runs one sequence at a time with a single scheduler event. Step times are
+ * computed from the moment the sequence was started, so delays don't accumulate errors.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ac_scheduler.h"
+
+#define AC_SEQUENCE_NAME_SIZE 32
+
+/**
+ * @brief Sequence step definition.
+ */
+typedef struct {
+    char signal[AC_SEQUENCE_NAME_SIZE]; /**< Name of the signal to be sent. */
+    uint32_t delay_ms; /**< Time to wait after each transmission, in milliseconds. */
+    uint32_t repeat; /**< Number of times the signal is sent. */
+    bool hold; /**< Send repeat frames instead of separate presses. */
+} AcSequenceStep;
+
+/**
+ * @brief AcSequence opaque type declaration.
+ */
+typedef struct AcSequence AcSequence;
+
+/**
+ * @brief AcSequenceSet opaque type declaration.
+ */
+typedef struct AcSequenceSet AcSequenceSet;
+
+/**
+ * @brief AcSequencer opaque type declaration.
+ */
+typedef struct AcSequencer AcSequencer;
+
+/**
+ * @brief Callback invoked by the sequencer for every step.
+ *
+ * The step may be handed over late, e.g. if the app was busy, so it carries the
+ * tick it was due at for the timing statistics.
+ *
+ * @param[in] step pointer to the step to be sent.
+ * @param[in] deadline tick at which the step is due.
+ * @param[in] run identifier of the sequence run the step belongs to, never 0.
+ * @param[in,out] context pointer to a user-specified object.
+ */
+typedef void (*AcSequencerSendCallback)(
+    const AcSequenceStep* step,
+    uint32_t deadline,
+    uint32_t run,
+    void* context);
+
+/**
+ * @brief Callback invoked by the sequencer once a sequence has completed.
+ *
+ * @param[in] sequence pointer to the sequence that completed.
+ * @param[in,out] context pointer to a user-specified object.
+ */
+typedef void (*AcSequencerDoneCallback)(const AcSequence* sequence, void* context);
+
+/**
+ * @brief Get the name of a sequence.
+ *
+ * @param[in] sequence pointer to the sequence to be queried.
+ * @returns pointer to a zero-terminated string containing the sequence name.
+ */
+const char* ac_sequence_get_name(const AcSequence* sequence);
+
+/**
+ * @brief Get the number of steps of a sequence.
+ *
+ * @param[in] sequence pointer to the sequence to be queried.
+ * @returns number of steps.
+ */
+size_t ac_sequence_get_steps_count(const AcSequence* sequence);
+
+/**
+ * @brief Test whether two sequences send a signal in common.
+ *
+ * E.g. turn-on and turn-off sequences both starting with a toggling Power button.
+ *
+ * @param[in] lhs pointer to the first sequence.
+ * @param[in] rhs pointer to the second sequence.
+ * @returns true if a signal name appears in both, false otherwise.
+ */
+bool ac_sequence_shares_signal(const AcSequence* lhs, const AcSequence* rhs);
+
+/**
+ * @brief Create a new, empty AcSequenceSet instance.
+ *
+ * @returns pointer to the instance created.
+ */
+AcSequenceSet* ac_sequence_set_alloc(void);
+
+/**
+ * @brief Delete an AcSequenceSet instance.
+ *
+ * @param[in,out] set pointer to the instance to be deleted.
+ */
+void ac_sequence_set_free(AcSequenceSet* set);
+
+/**
+ * @brief Add a sequence to a set.
+ *
+ * The steps are copied. A sequence with the same name is replaced.
+ *
+ * @param[in,out] set pointer to the instance to add the sequence to.
+ * @param[in] name pointer to a zero-terminated string containing the sequence name.
+ * @param[in] steps pointer to an array of steps.
+ * @param[in] steps_count number of elements in the steps array.
+ * @returns true if the sequence was added, false otherwise (e.g. name is too long).
+ */
+bool ac_sequence_set_add(
+    AcSequenceSet* set,
+    const char* name,
+    const AcSequenceStep* steps,
+    size_t steps_count);
+
+/**
+ * @brief Load sequences from a sequence file into a set.
+ *
+ * Sequences with names already present in the set replace the existing ones. The set
+ * is left untouched unless the whole file is valid.
+ *
+ * @param[in,out] set pointer to the instance to load into.
+ * @param[in] path pointer to a zero-terminated string containing the file path.
+ * @returns true if the whole file was loaded, false otherwise.
+ */
+bool ac_sequence_set_load(AcSequenceSet* set, const char* path);
+
+/**
+ * @brief Find a sequence by name.
+ *
+ * @param[in] set pointer to the instance to be queried.
+ * @param[in] name pointer to a zero-terminated string containing the sequence name.
+ * @returns pointer to the sequence, or NULL if there is no such sequence.
+ */
+const AcSequence* ac_sequence_set_get(const AcSequenceSet* set, const char* name);
+
+/**
+ * @brief Create a new AcSequencer instance.
+ *
+ * Callbacks are invoked from ac_scheduler_dispatch(), except for the first transmission
+ * which happens within ac_sequencer_start().
+ *
+ * @param[in,out] scheduler pointer to the scheduler to run the steps from.
+ * @param[in] send_callback callback to send a signal.
+ * @param[in] done_callback callback to report a completed sequence, may be NULL.
+ * @param[in,out] context pointer to a user-specified object passed to the callbacks.
+ * @returns pointer to the instance created.
+ */
+AcSequencer* ac_sequencer_alloc(
+    AcScheduler* scheduler,
+    AcSequencerSendCallback send_callback,
+    AcSequencerDoneCallback done_callback,
+    void* context);
+
+/**
+ * @brief Delete an AcSequencer instance, cancelling any running sequence.
+ *
+ * @param[in,out] sequencer pointer to the instance to be deleted.
+ */
+void ac_sequencer_free(AcSequencer* sequencer);
+
+/**
+ * @brief Start running a sequence.
+ *
+ * Any sequence already running is cancelled. The sequence must stay valid
+ * until it completes or is cancelled.
+ *
+ * @param[in,out] sequencer pointer to the instance to run the sequence.
+ * @param[in] sequence pointer to the sequence to be run.
+ */
+void ac_sequencer_start(AcSequencer* sequencer, const AcSequence* sequence);
+
+/**
+ * @brief Start running a sequence from one of its steps, e.g. to finish one interrupted
+ * after its first steps were sent.
+ *
+ * Same as ac_sequencer_start() otherwise. The first step is sent right away.
+ *
+ * @param[in,out] sequencer pointer to the instance to run the sequence.
+ * @param[in] sequence pointer to the sequence to be run.
+ * @param[in] step index of the first step to be sent, at most the number of steps.
+ */
+void ac_sequencer_start_at(AcSequencer* sequencer, const AcSequence* sequence, size_t step);
+
+/**
+ * @brief Cancel the running sequence, if any. The done callback is not invoked.
+ *
+ * @param[in,out] sequencer pointer to the instance to be stopped.
+ */
+void ac_sequencer_stop(AcSequencer* sequencer);
+
+/**
+ * @brief Test whether a sequence is running.
+ *
+ * @param[in] sequencer pointer to the instance to be tested.
+ * @returns true if a sequence is running, false otherwise.
+ */
+bool ac_sequencer_is_running(const AcSequencer* sequencer);
+
+/**
+ * @brief Get how far the running sequence got.
+ *
+ * @param[in] sequencer pointer to the instance to be queried.
+ * @returns number of steps handed over to the send callback, 0 if no sequence is running.
+ */
+size_t ac_sequencer_get_step(const AcSequencer* sequencer);
@@ -0,0 +1,103 @@
+#include "ac_stats.h"
+
+#include <furi.h>
+
+#define TAG "AcStats"
+
+static AcHistogram histograms[AcStatsIdMAX];
+
+static const char* const histogram_names[AcStatsIdMAX] = {
+    [AcStatsIdDispatchLateness] = "Wake late",
+    [AcStatsIdFireLateness] = "Fire late",
+    [AcStatsIdTransmitTime] = "TX time",
+    [AcStatsIdStepSpacing] = "Step gap",
+};
+
+static size_t ac_histogram_get_bucket(uint32_t value) {
+    size_t bucket = 0;
+    while(value > 0 && bucket < AC_STATS_BUCKETS - 1) {
+        value >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+// Upper end of the range counted in a bucket.
+static uint32_t ac_histogram_get_bucket_limit(size_t bucket) {
+    return bucket == 0 ? 0 : (1UL << bucket) - 1;
+}
+
+void ac_stats_record(AcStatsId id, uint32_t value) {
+    furi_assert(id < AcStatsIdMAX);
+    AcHistogram* histogram = &histograms[id];
+
+    if(histogram->count == 0 || value < histogram->min) {
+        histogram->min = value;
+    }
+    if(value > histogram->max) {
+        histogram->max = value;
+    }
+
+    histogram->buckets[ac_histogram_get_bucket(value)]++;
+    histogram->total += value;
+    histogram->count++;
+}
+
+const AcHistogram* ac_stats_get(AcStatsId id) {
+    furi_assert(id < AcStatsIdMAX);
+    return &histograms[id];
+}
+
+const char* ac_stats_get_name(AcStatsId id) {
+    furi_assert(id < AcStatsIdMAX);
+    return histogram_names[id];
+}
+
+uint32_t ac_histogram_get_mean(const AcHistogram* histogram) {
+    return histogram->count ? (uint32_t)(histogram->total / histogram->count) : 0;
+}
+
+uint32_t ac_histogram_get_percentile(const AcHistogram* histogram, uint32_t percent) {
+    // Rank of the value, rounded up so that the 100th percentile is the last one.
+    const uint64_t rank = ((uint64_t)histogram->count * percent + 99) / 100;
+    uint64_t seen = 0;
+
+    for(size_t i = 0; i < AC_STATS_BUCKETS; ++i) {
+        seen += histogram->buckets[i];
+        if(seen >= rank && seen > 0) {
+            return MIN(ac_histogram_get_bucket_limit(i), histogram->max);
+        }
+    }
+
+    return histogram->max;
+}
+
+void ac_stats_reset(void) {
+    memset(histograms, 0, sizeof(histograms));
+}
+
+void ac_stats_log(void) {
+    for(size_t id = 0; id < AcStatsIdMAX; ++id) {
+        const AcHistogram* histogram = &histograms[id];
+        FURI_LOG_I(
+            TAG,
+            "%s: n=%lu min=%lu mean=%lu p95=%lu max=%lu ms",
+            histogram_names[id],
+            histogram->count,
+            histogram->min,
+            ac_histogram_get_mean(histogram),
+            ac_histogram_get_percentile(histogram, 95),
+            histogram->max);
+
+        // Only the buckets in use, as "upper limit: count".
+        for(size_t i = 0; i < AC_STATS_BUCKETS; ++i) {
+            if(histogram->buckets[i]) {
+                FURI_LOG_I(
+                    TAG,
+                    "  <=%lu: %lu",
+                    MIN(ac_histogram_get_bucket_limit(i), histogram->max),
+                    histogram->buckets[i]);
+            }
+        }
+    }
+}
@@ -0,0 +1,90 @@
+/**
+ * @file ac_stats.h
+ * @brief Timing statistics of the sends, kept in fixed-size histograms.
+ *
+ * Values are in milliseconds (system ticks). Each histogram counts them in
+ * power-of-two buckets: bucket 0 holds 0, bucket i holds [2^(i-1), 2^i), and the
+ * last bucket everything above. Nothing is allocated, so recording is cheap
+ * enough to stay enabled.
+ *
+ * Each histogram is recorded from a single thread; reading it from another one may
+ * see a value being added, which is fine for display purposes.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#define AC_STATS_BUCKETS 16
+
+/**
+ * @brief Histograms kept by the app.
+ */
+typedef enum {
+    AcStatsIdDispatchLateness, /**< Time a scheduler event was dispatched after its deadline. */
+    AcStatsIdFireLateness, /**< Time a TX worker job started transmitting after it was due. */
+    AcStatsIdTransmitTime, /**< Time a TX worker job blocked for. */
+    AcStatsIdStepSpacing, /**< Time between the transmissions of consecutive steps. */
+    AcStatsIdMAX,
+} AcStatsId;
+
+/**
+ * @brief Histogram of millisecond values.
+ */
+typedef struct {
+    uint32_t buckets[AC_STATS_BUCKETS];
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+} AcHistogram;
+
+/**
+ * @brief Add a value to one of the histograms.
+ *
+ * @param[in] id histogram to be updated.
+ * @param[in] value value to be added, in milliseconds.
+ */
+void ac_stats_record(AcStatsId id, uint32_t value);
+
+/**
+ * @brief Get one of the histograms.
+ *
+ * @param[in] id histogram to be returned.
+ * @returns pointer to the histogram.
+ */
+const AcHistogram* ac_stats_get(AcStatsId id);
+
+/**
+ * @brief Get the name of one of the histograms.
+ *
+ * @param[in] id histogram to be named.
+ * @returns pointer to a zero-terminated string.
+ */
+const char* ac_stats_get_name(AcStatsId id);
+
+/**
+ * @brief Get the mean value of a histogram.
+ *
+ * @param[in] histogram pointer to the histogram.
+ * @returns mean value, 0 if the histogram is empty.
+ */
+uint32_t ac_histogram_get_mean(const AcHistogram* histogram);
+
+/**
+ * @brief Get an upper bound of a percentile of a histogram.
+ *
+ * @param[in] histogram pointer to the histogram.
+ * @param[in] percent percentile to be computed, 0 to 100.
+ * @returns upper end of the bucket holding the percentile, capped to the maximum.
+ */
+uint32_t ac_histogram_get_percentile(const AcHistogram* histogram, uint32_t percent);
+
+/**
+ * @brief Clear all histograms.
+ */
+void ac_stats_reset(void);
+
+/**
+ * @brief Write all histograms to the log.
+ */
+void ac_stats_log(void);
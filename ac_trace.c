@@ -0,0 +1,113 @@
+#include "ac_trace.h"
+
+#include <furi.h>
+
+#define TAG "AcTrace"
+
+#define AC_TRACE_MAGIC 0x52544341UL // "ACTR"
+#define AC_TRACE_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t count;
+    uint32_t dropped;
+} __attribute__((packed)) AcTraceHeader;
+
+typedef struct {
+    uint32_t tick;
+    uint16_t event;
+    uint16_t arg0;
+    uint32_t arg1;
+} __attribute__((packed)) AcTraceRecord;
+
+_Static_assert((AC_TRACE_SIZE & (AC_TRACE_SIZE - 1)) == 0, "AC_TRACE_SIZE must be a power of two");
+
+static AcTraceRecord trace_records[AC_TRACE_SIZE];
+static uint32_t trace_head = 0; // Events recorded so far, including overwritten ones.
+
+static const char* const trace_event_names[AcTraceEventMAX] = {
+    [AcTraceEventAppStart] = "app_start",
+    [AcTraceEventAppStop] = "app_stop",
+    [AcTraceEventSwitchDue] = "switch_due",
+    [AcTraceEventSequenceStart] = "sequence_start",
+    [AcTraceEventStepQueued] = "step_queued",
+    [AcTraceEventStateChanged] = "state_changed",
+    [AcTraceEventTransmit] = "transmit",
+    [AcTraceEventCountdownRefresh] = "countdown_refresh",
+    [AcTraceEventVerify] = "verify",
+};
+
+void ac_trace_record(AcTraceEvent event, uint16_t arg0, uint32_t arg1) {
+    furi_assert(event < AcTraceEventMAX);
+
+    // Each caller gets its own slot, so concurrent events don't overwrite each other.
+    const uint32_t index = __atomic_fetch_add(&trace_head, 1, __ATOMIC_RELAXED);
+    AcTraceRecord* record = &trace_records[index & (AC_TRACE_SIZE - 1)];
+
+    record->tick = furi_get_tick();
+    record->event = event;
+    record->arg0 = arg0;
+    record->arg1 = arg1;
+}
+
+// Number of events held in the buffer and index of the oldest one.
+static uint32_t ac_trace_get_range(uint32_t* first) {
+    const uint32_t head = __atomic_load_n(&trace_head, __ATOMIC_RELAXED);
+    const uint32_t count = MIN(head, (uint32_t)AC_TRACE_SIZE);
+
+    *first = head - count;
+    return count;
+}
+
+void ac_trace_log(void) {
+    uint32_t first;
+    const uint32_t count = ac_trace_get_range(&first);
+
+    for(uint32_t i = 0; i < count; ++i) {
+        const AcTraceRecord* record = &trace_records[(first + i) & (AC_TRACE_SIZE - 1)];
+        const char* name =
+            record->event < AcTraceEventMAX ? trace_event_names[record->event] : "unknown";
+        FURI_LOG_I(
+            TAG, "%lu %s %u %lu", record->tick, name, (unsigned)record->arg0, record->arg1);
+    }
+}
+
+bool ac_trace_save(Storage* storage, const char* path) {
+    File* file = storage_file_alloc(storage);
+    bool success = false;
+
+    uint32_t first;
+    const uint32_t count = ac_trace_get_range(&first);
+    const AcTraceHeader header = {
+        .magic = AC_TRACE_MAGIC,
+        .version = AC_TRACE_VERSION,
+        .record_size = sizeof(AcTraceRecord),
+        .count = count,
+        .dropped = first,
+    };
+
+    do {
+        if(!storage_file_open(file, path, FSAM_WRITE, FSOM_CREATE_ALWAYS)) break;
+        if(storage_file_write(file, &header, sizeof(header)) != sizeof(header)) break;
+
+        // The records wrap around the end of the buffer at most once.
+        const uint32_t start = first & (AC_TRACE_SIZE - 1);
+        const size_t tail_bytes = MIN(count, AC_TRACE_SIZE - start) * sizeof(AcTraceRecord);
+        const size_t head_bytes = count * sizeof(AcTraceRecord) - tail_bytes;
+        if(storage_file_write(file, &trace_records[start], tail_bytes) != tail_bytes) break;
+        if(storage_file_write(file, trace_records, head_bytes) != head_bytes) break;
+
+        success = true;
+    } while(false);
+
+    storage_file_close(file);
+    storage_file_free(file);
+
+    if(!success) {
+        FURI_LOG_E(TAG, "Failed to save %s", path);
+    }
+
+    return success;
+}
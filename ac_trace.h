@@ -0,0 +1,61 @@
+/**
+ * @file ac_trace.h
+ * @brief Binary event trace kept in a preallocated ring buffer.
+ *
+ * Recording an event only stores a tick, an event id and two arguments, so it
+ * replaces informational logging on paths that run on every send. The buffer keeps
+ * the last AC_TRACE_SIZE events; older ones are overwritten. The trace can be
+ * decoded to the log, or saved to a file as-is:
+ *
+ * - header: "ACTR" magic, version (u16), record size (u16), records count (u32),
+ *   dropped events count (u32);
+ * - records, oldest first: tick (u32), event id (u16), arg0 (u16), arg1 (u32).
+ *
+ * Events may be recorded from any thread.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <storage/storage.h>
+
+#define AC_TRACE_SIZE 256 // Must be a power of two
+
+/**
+ * @brief Traced events, with the meaning of their arguments.
+ */
+typedef enum {
+    AcTraceEventAppStart, /**< No arguments. */
+    AcTraceEventAppStop, /**< No arguments. */
+    AcTraceEventSwitchDue, /**< arg0: switches skipped, arg1: RTC timestamp. */
+    AcTraceEventSequenceStart, /**< arg0: steps count, arg1: first step sent. */
+    AcTraceEventStepQueued, /**< arg0: repeat count, arg1: 1 for hold, 0 otherwise. */
+    AcTraceEventStateChanged, /**< arg0: 1 for on, 0 for off, arg1: RTC timestamp. */
+    AcTraceEventTransmit, /**< arg0: frames count, arg1: duration in milliseconds. */
+    AcTraceEventCountdownRefresh, /**< No arguments. */
+    AcTraceEventVerify, /**< arg0: retries so far, arg1: 1 if confirmed, 0 otherwise. */
+    AcTraceEventMAX,
+} AcTraceEvent;
+
+/**
+ * @brief Record an event.
+ *
+ * @param[in] event event to be recorded.
+ * @param[in] arg0 first argument, see AcTraceEvent.
+ * @param[in] arg1 second argument, see AcTraceEvent.
+ */
+void ac_trace_record(AcTraceEvent event, uint16_t arg0, uint32_t arg1);
+
+/**
+ * @brief Decode the events held in the buffer to the log, oldest first.
+ */
+void ac_trace_log(void);
+
+/**
+ * @brief Save the events held in the buffer to a file, replacing it.
+ *
+ * @param[in,out] storage pointer to a storage API instance.
+ * @param[in] path pointer to a zero-terminated string containing the file path.
+ * @returns true if the file was written, false otherwise.
+ */
+bool ac_trace_save(Storage* storage, const char* path);
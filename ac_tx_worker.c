@@ -0,0 +1,186 @@
+#include "ac_tx_worker.h"
+#include "ac_stats.h"
+#include "ac_trace.h"
+#include "ac_verifier.h"
+
+#include <furi.h>
+
+#define TAG "AcTxWorker"
+
+#define AC_TX_WORKER_STACK_SIZE 1024
+#define AC_TX_WORKER_QUEUE_SIZE 16
+#define AC_TX_WORKER_MAX_BURST 16
+#define AC_TX_WORKER_HOLD_POLL_MS 100 // Checks for a stop while jobs are held
+
+typedef struct {
+    const InfraredSignal* signal; // NULL asks the thread to exit.
+    uint32_t count;
+    uint32_t gap_ms;
+    bool hold; // Send count frames using protocol repeat frames.
+    AcTxWorkerTiming timing;
+} AcTxWorkerJob;
+
+struct AcTxWorker {
+    FuriThread* thread;
+    FuriMessageQueue* queue;
+    uint32_t pending; // Jobs queued or being sent, updated atomically.
+    bool stopping; // Set by ac_tx_worker_stop(), read atomically.
+};
+
+static void ac_tx_worker_transmit(const AcTxWorkerJob* job) {
+    if(job->hold) {
+        infrared_signal_transmit_times(job->signal, job->count);
+        return;
+    } else if(job->count == 1) {
+        infrared_signal_transmit(job->signal);
+        return;
+    }
+
+    const InfraredSignal* signals[AC_TX_WORKER_MAX_BURST];
+    uint32_t gaps[AC_TX_WORKER_MAX_BURST - 1];
+
+    for(size_t i = 0; i < AC_TX_WORKER_MAX_BURST; ++i) {
+        signals[i] = job->signal;
+        if(i < COUNT_OF(gaps)) {
+            gaps[i] = job->gap_ms * 1000;
+        }
+    }
+
+    // Longer bursts are split, keeping the same gap between the parts.
+    for(uint32_t left = job->count; left > 0;) {
+        const uint32_t count = MIN(left, AC_TX_WORKER_MAX_BURST);
+        if(!infrared_signal_transmit_burst(signals, gaps, count)) {
+            FURI_LOG_E(TAG, "Burst transmission failed");
+            break;
+        }
+
+        left -= count;
+        if(left > 0) {
+            furi_delay_ms(job->gap_ms);
+        }
+    }
+}
+
+static int32_t ac_tx_worker_thread(void* context) {
+    AcTxWorker* worker = context;
+    AcTxWorkerJob job;
+    uint32_t last_sequence = 0; // Sequence run of the previous job.
+    uint32_t last_start = 0; // Tick at which the previous job started.
+
+    while(true) {
+        if(furi_message_queue_get(worker->queue, &job, FuriWaitForever) != FuriStatusOk) continue;
+        if(!job.signal) break;
+
+        // Held while an infrared check owns the receiver. Not when stopping though: the
+        // check can't end then, as the main thread is waiting for this one.
+        bool claimed;
+        while(!(claimed = ac_verifier_acquire_transmitter(AC_TX_WORKER_HOLD_POLL_MS)) &&
+              !__atomic_load_n(&worker->stopping, __ATOMIC_ACQUIRE)) {
+        }
+        if(!claimed) {
+            FURI_LOG_W(TAG, "Receiver in use, transmission dropped");
+            __atomic_sub_fetch(&worker->pending, 1, __ATOMIC_RELEASE);
+            continue;
+        }
+
+        // Measured as the job goes on air, so the time spent queued behind others counts.
+        const uint32_t start = furi_get_tick();
+        ac_stats_record(AcStatsIdFireLateness, start - job.timing.deadline);
+        if(job.timing.sequence != 0 && job.timing.sequence == last_sequence) {
+            ac_stats_record(AcStatsIdStepSpacing, start - last_start);
+        }
+        last_sequence = job.timing.sequence;
+        last_start = start;
+
+        ac_tx_worker_transmit(&job);
+        ac_verifier_release_transmitter();
+
+        const uint32_t duration = furi_get_tick() - start;
+        ac_stats_record(AcStatsIdTransmitTime, duration);
+        ac_trace_record(AcTraceEventTransmit, job.count, duration);
+        __atomic_sub_fetch(&worker->pending, 1, __ATOMIC_RELEASE);
+    }
+
+    return 0;
+}
+
+AcTxWorker* ac_tx_worker_alloc(void) {
+    AcTxWorker* worker = malloc(sizeof(AcTxWorker));
+
+    worker->queue = furi_message_queue_alloc(AC_TX_WORKER_QUEUE_SIZE, sizeof(AcTxWorkerJob));
+    worker->pending = 0;
+    worker->stopping = false;
+    worker->thread =
+        furi_thread_alloc_ex(TAG, AC_TX_WORKER_STACK_SIZE, ac_tx_worker_thread, worker);
+
+    return worker;
+}
+
+void ac_tx_worker_free(AcTxWorker* worker) {
+    furi_thread_free(worker->thread);
+    furi_message_queue_free(worker->queue);
+    free(worker);
+}
+
+void ac_tx_worker_start(AcTxWorker* worker) {
+    furi_thread_start(worker->thread);
+}
+
+void ac_tx_worker_stop(AcTxWorker* worker) {
+    const AcTxWorkerJob job = {.signal = NULL};
+    __atomic_store_n(&worker->stopping, true, __ATOMIC_RELEASE);
+    furi_message_queue_put(worker->queue, &job, FuriWaitForever);
+    furi_thread_join(worker->thread);
+}
+
+bool ac_tx_worker_is_idle(const AcTxWorker* worker) {
+    return __atomic_load_n(&worker->pending, __ATOMIC_ACQUIRE) == 0;
+}
+
+bool ac_tx_worker_enqueue(AcTxWorker* worker, const InfraredSignal* signal) {
+    return ac_tx_worker_enqueue_burst(worker, signal, 1, 0, NULL);
+}
+
+static bool ac_tx_worker_put(
+    AcTxWorker* worker,
+    AcTxWorkerJob* job,
+    const AcTxWorkerTiming* timing) {
+    furi_assert(job->signal);
+    furi_assert(job->count > 0);
+
+    if(timing) {
+        job->timing = *timing;
+    } else {
+        job->timing.deadline = furi_get_tick();
+        job->timing.sequence = 0;
+    }
+
+    // Counted first, so the job is never seen as sent before it is queued.
+    __atomic_add_fetch(&worker->pending, 1, __ATOMIC_RELAXED);
+    if(furi_message_queue_put(worker->queue, job, 0) != FuriStatusOk) {
+        __atomic_sub_fetch(&worker->pending, 1, __ATOMIC_RELAXED);
+        FURI_LOG_E(TAG, "Transmit queue is full");
+        return false;
+    }
+
+    return true;
+}
+
+bool ac_tx_worker_enqueue_hold(
+    AcTxWorker* worker,
+    const InfraredSignal* signal,
+    uint32_t count,
+    const AcTxWorkerTiming* timing) {
+    AcTxWorkerJob job = {.signal = signal, .count = count, .hold = true};
+    return ac_tx_worker_put(worker, &job, timing);
+}
+
+bool ac_tx_worker_enqueue_burst(
+    AcTxWorker* worker,
+    const InfraredSignal* signal,
+    uint32_t count,
+    uint32_t gap_ms,
+    const AcTxWorkerTiming* timing) {
+    AcTxWorkerJob job = {.signal = signal, .count = count, .gap_ms = gap_ms};
+    return ac_tx_worker_put(worker, &job, timing);
+}
@@ -0,0 +1,115 @@
+/**
+ * @file ac_tx_worker.h
+ * @brief Infrared transmit worker.
+ *
+ * Transmissions block for as long as the signal is on air. The worker runs them on
+ * its own thread, so that timer callbacks only have to queue a signal and return.
+ * Queued signals are sent one by one in the order they were queued. While an infrared
+ * check owns the receiver (see ac_verifier.h), they are held until it is done.
+ */
+#pragma once
+
+#include "infrared_signal.h"
+
+/**
+ * @brief When a job is due, for the timing statistics (see ac_stats.h).
+ */
+typedef struct {
+    uint32_t deadline; /**< Tick at which the job is due to start. */
+    uint32_t sequence; /**< Sequence run of the job, 0 if none. Step spacing is measured
+                            between consecutive jobs of the same run. */
+} AcTxWorkerTiming;
+
+/**
+ * @brief AcTxWorker opaque type declaration.
+ */
+typedef struct AcTxWorker AcTxWorker;
+
+/**
+ * @brief Create a new AcTxWorker instance.
+ *
+ * @returns pointer to the instance created.
+ */
+AcTxWorker* ac_tx_worker_alloc(void);
+
+/**
+ * @brief Delete an AcTxWorker instance.
+ *
+ * The worker must be stopped prior to this call.
+ *
+ * @param[in,out] worker pointer to the instance to be deleted.
+ */
+void ac_tx_worker_free(AcTxWorker* worker);
+
+/**
+ * @brief Start the worker thread.
+ *
+ * @param[in,out] worker pointer to the instance to be started.
+ */
+void ac_tx_worker_start(AcTxWorker* worker);
+
+/**
+ * @brief Stop the worker thread.
+ *
+ * Signals already queued are transmitted before the thread exits, except those held
+ * for an infrared check, which are dropped.
+ *
+ * @param[in,out] worker pointer to the instance to be stopped.
+ */
+void ac_tx_worker_stop(AcTxWorker* worker);
+
+/**
+ * @brief Test whether the worker has sent everything queued so far.
+ *
+ * @param[in] worker pointer to the instance to be tested.
+ * @returns true if nothing is queued or being sent, false otherwise.
+ */
+bool ac_tx_worker_is_idle(const AcTxWorker* worker);
+
+/**
+ * @brief Queue a signal for transmission without waiting for it to be sent.
+ *
+ * The signal is not copied and must stay valid until the worker is stopped.
+ *
+ * @param[in,out] worker pointer to the instance to queue the signal on.
+ * @param[in] signal pointer to the signal to be transmitted.
+ * @returns true if the signal was queued, false if the queue is full.
+ */
+bool ac_tx_worker_enqueue(AcTxWorker* worker, const InfraredSignal* signal);
+
+/**
+ * @brief Queue a signal to be transmitted several times in a single burst.
+ *
+ * The transmissions are sent back to back within one HAL transmit session,
+ * see infrared_signal_transmit_burst().
+ *
+ * @param[in,out] worker pointer to the instance to queue the signal on.
+ * @param[in] signal pointer to the signal to be transmitted.
+ * @param[in] count number of times the signal is sent.
+ * @param[in] gap_ms silence between consecutive transmissions, in milliseconds.
+ * @param[in] timing pointer to when the burst is due, NULL if it is due right away.
+ * @returns true if the burst was queued, false if the queue is full.
+ */
+bool ac_tx_worker_enqueue_burst(
+    AcTxWorker* worker,
+    const InfraredSignal* signal,
+    uint32_t count,
+    uint32_t gap_ms,
+    const AcTxWorkerTiming* timing);
+
+/**
+ * @brief Queue a signal to be transmitted as if its button was held.
+ *
+ * See infrared_signal_transmit_times().
+ *
+ * @param[in,out] worker pointer to the instance to queue the signal on.
+ * @param[in] signal pointer to the signal to be transmitted.
+ * @param[in] count number of frames to be sent, at least 1.
+ * @param[in] timing pointer to when the transmission is due, NULL if it is due right away.
+ * @returns true if the transmission was queued, false if the queue is full.
+ */
+bool ac_tx_worker_enqueue_hold(
+    AcTxWorker* worker,
+    const InfraredSignal* signal,
+    uint32_t count,
+    const AcTxWorkerTiming* timing);
@@ -0,0 +1,156 @@
+#include "ac_verifier.h"
+
+#include <furi.h>
+#include <furi_hal_resources.h>
+#include <infrared_worker.h>
+
+#define TAG "AcVerifier"
+
+#define AC_VERIFIER_GPIO_PREFIX "gpio "
+#define AC_VERIFIER_TRANSMITTER_POLL_MS 10
+
+typedef enum {
+    AcVerifierInfraredIdle,
+    AcVerifierInfraredTransmitting,
+    AcVerifierInfraredReceiving,
+} AcVerifierInfraredOwner;
+
+struct AcVerifier {
+    AcVerifyMode mode;
+    const GpioPin* pin;
+
+    InfraredWorker* worker; // Only while an infrared check is running.
+    InfraredMessage ack;
+    volatile bool acked; // Set from the worker thread.
+};
+
+// Owner of the infrared hardware, which can't receive and transmit at once: the infrared
+// check in progress, or the transmission. Updated atomically, as both come from different
+// threads.
+static uint32_t infrared_owner = AcVerifierInfraredIdle;
+
+static bool ac_verifier_claim_infrared(AcVerifierInfraredOwner owner) {
+    uint32_t expected = AcVerifierInfraredIdle;
+    return __atomic_compare_exchange_n(
+        &infrared_owner, &expected, owner, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+static void ac_verifier_release_infrared(void) {
+    __atomic_store_n(&infrared_owner, AcVerifierInfraredIdle, __ATOMIC_RELEASE);
+}
+
+bool ac_verifier_acquire_transmitter(uint32_t timeout) {
+    const uint32_t start = furi_get_tick();
+
+    while(!ac_verifier_claim_infrared(AcVerifierInfraredTransmitting)) {
+        if(furi_get_tick() - start >= timeout) return false;
+        furi_delay_ms(AC_VERIFIER_TRANSMITTER_POLL_MS);
+    }
+
+    return true;
+}
+
+void ac_verifier_release_transmitter(void) {
+    furi_assert(infrared_owner == AcVerifierInfraredTransmitting);
+    ac_verifier_release_infrared();
+}
+
+bool ac_verifier_parse(const char* text, AcVerifyMode* mode, const GpioPin** pin) {
+    *pin = NULL;
+
+    if(strcmp(text, "none") == 0) {
+        *mode = AcVerifyModeNone;
+        return true;
+    } else if(strcmp(text, "ir") == 0) {
+        *mode = AcVerifyModeIr;
+        return true;
+    } else if(strncmp(text, AC_VERIFIER_GPIO_PREFIX, strlen(AC_VERIFIER_GPIO_PREFIX)) == 0) {
+        const char* name = text + strlen(AC_VERIFIER_GPIO_PREFIX);
+        for(size_t i = 0; i < gpio_pins_count; ++i) {
+            if(!gpio_pins[i].debug && strcmp(gpio_pins[i].name, name) == 0) {
+                *mode = AcVerifyModeGpio;
+                *pin = gpio_pins[i].pin;
+                return true;
+            }
+        }
+    }
+
+    FURI_LOG_E(TAG, "Invalid verification: %s", text);
+    return false;
+}
+
+AcVerifier* ac_verifier_alloc(AcVerifyMode mode, const GpioPin* pin) {
+    furi_assert(mode != AcVerifyModeNone);
+    furi_assert((mode == AcVerifyModeGpio) == (pin != NULL));
+
+    AcVerifier* verifier = malloc(sizeof(AcVerifier));
+
+    verifier->mode = mode;
+    verifier->pin = pin;
+    verifier->worker = NULL;
+    verifier->acked = false;
+
+    if(pin) {
+        furi_hal_gpio_init(pin, GpioModeInput, GpioPullDown, GpioSpeedLow);
+    }
+
+    return verifier;
+}
+
+static void ac_verifier_stop_receiver(AcVerifier* verifier) {
+    if(verifier->worker) {
+        infrared_worker_rx_stop(verifier->worker);
+        infrared_worker_free(verifier->worker);
+        verifier->worker = NULL;
+        ac_verifier_release_infrared();
+    }
+}
+
+void ac_verifier_free(AcVerifier* verifier) {
+    ac_verifier_stop_receiver(verifier);
+
+    if(verifier->pin) {
+        furi_hal_gpio_init_simple(verifier->pin, GpioModeAnalog);
+    }
+
+    free(verifier);
+}
+
+// Worker callback, invoked for every signal received during an infrared check.
+static void ac_verifier_received_callback(void* context, InfraredWorkerSignal* received_signal) {
+    AcVerifier* verifier = context;
+    if(!infrared_worker_signal_is_decoded(received_signal)) return;
+
+    const InfraredMessage* message = infrared_worker_get_decoded_signal(received_signal);
+    if(message->protocol == verifier->ack.protocol && message->address == verifier->ack.address &&
+       message->command == verifier->ack.command) {
+        verifier->acked = true;
+    }
+}
+
+bool ac_verifier_start(AcVerifier* verifier, const InfraredMessage* ack) {
+    verifier->acked = false;
+    if(verifier->mode != AcVerifyModeIr) return true;
+
+    furi_assert(ack);
+    furi_assert(!verifier->worker);
+    if(!ac_verifier_claim_infrared(AcVerifierInfraredReceiving)) return false;
+
+    verifier->ack = *ack;
+    verifier->worker = infrared_worker_alloc();
+    infrared_worker_rx_enable_signal_decoding(verifier->worker, true);
+    infrared_worker_rx_set_received_signal_callback(
+        verifier->worker, ac_verifier_received_callback, verifier);
+    infrared_worker_rx_start(verifier->worker);
+
+    return true;
+}
+
+bool ac_verifier_finish(AcVerifier* verifier, bool on) {
+    if(verifier->mode == AcVerifyModeGpio) {
+        return furi_hal_gpio_read(verifier->pin) == on;
+    }
+
+    ac_verifier_stop_receiver(verifier);
+    return verifier->acked;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file ac_verifier.h
+ * @brief Confirmation that a unit actually switched state.
+ *
+ * Two ways are supported:
+ * - ir: the infrared receiver listens for the acknowledgement the unit sends back,
+ *   learned into the remote file as Ack_on and Ack_off (decoded signals only);
+ * - gpio: an external sensor on a GPIO pin reads high while the unit is on.
+ *
+ * A check is started once the signals are sent and finished after a while. Only
+ * one infrared check may run at a time, as there is a single receiver, and nothing
+ * may be transmitted while it runs: transmitters claim the hardware with
+ * ac_verifier_acquire_transmitter() first.
+ */
+#pragma once
+
+#include <furi_hal_gpio.h>
+#include <infrared/encoder_decoder/infrared.h>
+
+/**
+ * @brief How a device confirms that its unit switched.
+ */
+typedef enum {
+    AcVerifyModeNone, /**< Switches are assumed to work. */
+    AcVerifyModeIr, /**< An acknowledgement is received over infrared. */
+    AcVerifyModeGpio, /**< An external sensor is read from a GPIO pin. */
+} AcVerifyMode;
+
+/**
+ * @brief AcVerifier opaque type declaration.
+ */
+typedef struct AcVerifier AcVerifier;
+
+/**
+ * @brief Parse a verification setting, e.g. from a devices file.
+ *
+ * @param[in] text pointer to a zero-terminated string: "none", "ir" or "gpio <pin>",
+ *                 the pin being named as on the Flipper, e.g. "gpio PA7".
+ * @param[out] mode pointer to the variable to hold the mode.
+ * @param[out] pin pointer to the variable to hold the pin, NULL unless mode is gpio.
+ * @returns true if the setting is valid, false otherwise.
+ */
+bool ac_verifier_parse(const char* text, AcVerifyMode* mode, const GpioPin** pin);
+
+/**
+ * @brief Claim the infrared hardware to transmit, waiting for any infrared check to end.
+ *
+ * May be called from any thread. Infrared checks don't start while it is claimed.
+ *
+ * @param[in] timeout longest time to wait, in milliseconds.
+ * @returns true if the hardware was claimed, false if a check still owns the receiver.
+ */
+bool ac_verifier_acquire_transmitter(uint32_t timeout);
+
+/**
+ * @brief Give back the infrared hardware claimed by ac_verifier_acquire_transmitter().
+ */
+void ac_verifier_release_transmitter(void);
+
+/**
+ * @brief Create a new AcVerifier instance.
+ *
+ * @param[in] mode verification mode, other than AcVerifyModeNone.
+ * @param[in] pin pointer to the pin to be read in gpio mode, NULL otherwise.
+ * @returns pointer to the instance created.
+ */
+AcVerifier* ac_verifier_alloc(AcVerifyMode mode, const GpioPin* pin);
+
+/**
+ * @brief Delete an AcVerifier instance, stopping any check in progress.
+ *
+ * @param[in,out] verifier pointer to the instance to be deleted.
+ */
+void ac_verifier_free(AcVerifier* verifier);
+
+/**
+ * @brief Start a check.
+ *
+ * @param[in,out] verifier pointer to the instance to be used.
+ * @param[in] ack pointer to the acknowledgement to wait for in ir mode, ignored otherwise.
+ * @returns true if the check started, false if the receiver is in use or a
+ *          transmission is in progress.
+ */
+bool ac_verifier_start(AcVerifier* verifier, const InfraredMessage* ack);
+
+/**
+ * @brief Finish a check.
+ *
+ * In gpio mode, this merely reads the sensor and may be called at any time.
+ *
+ * @param[in,out] verifier pointer to the instance to be used.
+ * @param[in] on state the unit should have switched to.
+ * @returns true if the switch was confirmed, false otherwise.
+ */
+bool ac_verifier_finish(AcVerifier* verifier, bool on);
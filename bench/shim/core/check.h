@@ -0,0 +1,28 @@
+/**
+ * @file check.h
+ * @brief Host stand-in for furi checks, which abort on failure.
+ */
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define furi_crash(message)                                                     \
+    do {                                                                        \
+        fprintf(stderr, "%s:%d: furi_crash: %s\n", __FILE__, __LINE__, message); \
+        abort();                                                                \
+    } while(false)
+
+#define furi_check(condition)                 \
+    do {                                      \
+        if(!(condition)) {                    \
+            furi_crash("furi_check failed");  \
+        }                                     \
+    } while(false)
+
+#define furi_assert(condition)                \
+    do {                                      \
+        if(!(condition)) {                    \
+            furi_crash("furi_assert failed"); \
+        }                                     \
+    } while(false)
@@ -0,0 +1,299 @@
+#include <flipper_format/flipper_format.h>
+
+#include <ctype.h>
+
+#define FLIPPER_FORMAT_READ_CHUNK_SIZE 64
+
+#define FLIPPER_FORMAT_FILETYPE_KEY "Filetype"
+#define FLIPPER_FORMAT_VERSION_KEY "Version"
+
+struct FlipperFormat {
+    Stream* stream;
+    bool is_file;
+    FuriString* line;
+};
+
+static FlipperFormat* flipper_format_alloc(Stream* stream, bool is_file) {
+    FlipperFormat* flipper_format = malloc(sizeof(FlipperFormat));
+    furi_check(flipper_format);
+
+    flipper_format->stream = stream;
+    flipper_format->is_file = is_file;
+    flipper_format->line = furi_string_alloc();
+
+    return flipper_format;
+}
+
+FlipperFormat* flipper_format_string_alloc(void) {
+    return flipper_format_alloc(string_stream_alloc(), false);
+}
+
+FlipperFormat* flipper_format_file_alloc(Storage* storage) {
+    UNUSED(storage);
+    return flipper_format_alloc(file_stream_alloc(), true);
+}
+
+FlipperFormat* flipper_format_buffered_file_alloc(Storage* storage) {
+    // stdio already buffers, so both kinds of file are the same here.
+    return flipper_format_file_alloc(storage);
+}
+
+bool flipper_format_file_open_existing(FlipperFormat* flipper_format, const char* path) {
+    furi_assert(flipper_format->is_file);
+    return file_stream_open(flipper_format->stream, path, false);
+}
+
+bool flipper_format_file_open_always(FlipperFormat* flipper_format, const char* path) {
+    furi_assert(flipper_format->is_file);
+    return file_stream_open(flipper_format->stream, path, true);
+}
+
+bool flipper_format_file_close(FlipperFormat* flipper_format) {
+    furi_assert(flipper_format->is_file);
+    return file_stream_close(flipper_format->stream);
+}
+
+bool flipper_format_buffered_file_open_existing(FlipperFormat* flipper_format, const char* path) {
+    return flipper_format_file_open_existing(flipper_format, path);
+}
+
+bool flipper_format_buffered_file_open_always(FlipperFormat* flipper_format, const char* path) {
+    return flipper_format_file_open_always(flipper_format, path);
+}
+
+bool flipper_format_buffered_file_close(FlipperFormat* flipper_format) {
+    return flipper_format_file_close(flipper_format);
+}
+
+void flipper_format_free(FlipperFormat* flipper_format) {
+    stream_free(flipper_format->stream);
+    furi_string_free(flipper_format->line);
+    free(flipper_format);
+}
+
+Stream* flipper_format_get_raw_stream(FlipperFormat* flipper_format) {
+    return flipper_format->stream;
+}
+
+bool flipper_format_rewind(FlipperFormat* flipper_format) {
+    return stream_rewind(flipper_format->stream);
+}
+
+// Read a line without its end of line, leaving the stream at the start of the next one.
+static bool flipper_format_read_line(Stream* stream, FuriString* line) {
+    uint8_t chunk[FLIPPER_FORMAT_READ_CHUNK_SIZE];
+    bool success = false;
+
+    furi_string_reset(line);
+
+    for(size_t size; (size = stream_read(stream, chunk, sizeof(chunk))) > 0;) {
+        success = true;
+
+        const uint8_t* end = memchr(chunk, '\n', size);
+        if(end) {
+            const size_t used = end - chunk;
+            furi_string_cat_strn(line, (const char*)chunk, used);
+            stream_seek(stream, (int32_t)(used + 1) - (int32_t)size, StreamOffsetFromCurrent);
+            break;
+        }
+
+        furi_string_cat_strn(line, (const char*)chunk, size);
+    }
+
+    return success;
+}
+
+// Find the next line of a key, returning where its value starts or NULL if there is none.
+static const char* flipper_format_seek_to_key(FlipperFormat* flipper_format, const char* key) {
+    const size_t key_size = strlen(key);
+
+    while(flipper_format_read_line(flipper_format->stream, flipper_format->line)) {
+        const char* line = furi_string_get_cstr(flipper_format->line);
+        if(strncmp(line, key, key_size) != 0 || line[key_size] != ':') continue;
+
+        const char* value = line + key_size + 1;
+        while(*value == ' ') {
+            value++;
+        }
+        return value;
+    }
+
+    return NULL;
+}
+
+static size_t flipper_format_count_values(const char* value) {
+    size_t count = 0;
+
+    while(*value) {
+        while(isspace((unsigned char)*value)) {
+            value++;
+        }
+        if(!*value) break;
+
+        count++;
+        while(*value && !isspace((unsigned char)*value)) {
+            value++;
+        }
+    }
+
+    return count;
+}
+
+static bool flipper_format_write_line(FlipperFormat* flipper_format) {
+    furi_string_cat_str(flipper_format->line, "\n");
+    const size_t size = furi_string_size(flipper_format->line);
+    return stream_write(
+               flipper_format->stream,
+               (const uint8_t*)furi_string_get_cstr(flipper_format->line),
+               size) == size;
+}
+
+bool flipper_format_read_header(
+    FlipperFormat* flipper_format,
+    FuriString* filetype,
+    uint32_t* version) {
+    return flipper_format_read_string(flipper_format, FLIPPER_FORMAT_FILETYPE_KEY, filetype) &&
+           flipper_format_read_uint32(flipper_format, FLIPPER_FORMAT_VERSION_KEY, version, 1);
+}
+
+bool flipper_format_write_header_cstr(
+    FlipperFormat* flipper_format,
+    const char* filetype,
+    const uint32_t version) {
+    return flipper_format_write_string_cstr(
+               flipper_format, FLIPPER_FORMAT_FILETYPE_KEY, filetype) &&
+           flipper_format_write_uint32(flipper_format, FLIPPER_FORMAT_VERSION_KEY, &version, 1);
+}
+
+bool flipper_format_get_value_count(
+    FlipperFormat* flipper_format,
+    const char* key,
+    uint32_t* count) {
+    const size_t position = stream_tell(flipper_format->stream);
+    const char* value = flipper_format_seek_to_key(flipper_format, key);
+
+    if(value) {
+        *count = flipper_format_count_values(value);
+    }
+
+    // Counting does not move the stream, so that the values can then be read.
+    return stream_seek(flipper_format->stream, position, StreamOffsetFromStart) && value;
+}
+
+bool flipper_format_read_string(FlipperFormat* flipper_format, const char* key, FuriString* data) {
+    const char* value = flipper_format_seek_to_key(flipper_format, key);
+    if(!value) return false;
+
+    size_t size = strlen(value);
+    while(size && isspace((unsigned char)value[size - 1])) {
+        size--;
+    }
+
+    furi_string_set_strn(data, value, size);
+    return true;
+}
+
+bool flipper_format_write_string_cstr(
+    FlipperFormat* flipper_format,
+    const char* key,
+    const char* data) {
+    furi_string_printf(flipper_format->line, "%s: %s", key, data);
+    return flipper_format_write_line(flipper_format);
+}
+
+bool flipper_format_read_hex(
+    FlipperFormat* flipper_format,
+    const char* key,
+    uint8_t* data,
+    const uint16_t data_size) {
+    const char* value = flipper_format_seek_to_key(flipper_format, key);
+    if(!value) return false;
+
+    for(uint16_t i = 0; i < data_size; ++i) {
+        char* end;
+        const unsigned long byte = strtoul(value, &end, 16);
+        if(end == value || byte > UINT8_MAX) return false;
+        data[i] = byte;
+        value = end;
+    }
+
+    return true;
+}
+
+bool flipper_format_write_hex(
+    FlipperFormat* flipper_format,
+    const char* key,
+    const uint8_t* data,
+    const uint16_t data_size) {
+    furi_string_printf(flipper_format->line, "%s:", key);
+    for(uint16_t i = 0; i < data_size; ++i) {
+        furi_string_cat_printf(flipper_format->line, " %02X", data[i]);
+    }
+    return flipper_format_write_line(flipper_format);
+}
+
+bool flipper_format_read_uint32(
+    FlipperFormat* flipper_format,
+    const char* key,
+    uint32_t* data,
+    const uint16_t data_size) {
+    const char* value = flipper_format_seek_to_key(flipper_format, key);
+    if(!value) return false;
+
+    for(uint16_t i = 0; i < data_size; ++i) {
+        char* end;
+        const unsigned long number = strtoul(value, &end, 10);
+        if(end == value || number > UINT32_MAX) return false;
+        data[i] = number;
+        value = end;
+    }
+
+    return true;
+}
+
+bool flipper_format_write_uint32(
+    FlipperFormat* flipper_format,
+    const char* key,
+    const uint32_t* data,
+    const uint16_t data_size) {
+    furi_string_printf(flipper_format->line, "%s:", key);
+    for(uint16_t i = 0; i < data_size; ++i) {
+        furi_string_cat_printf(flipper_format->line, " %lu", (unsigned long)data[i]);
+    }
+    return flipper_format_write_line(flipper_format);
+}
+
+bool flipper_format_read_float(
+    FlipperFormat* flipper_format,
+    const char* key,
+    float* data,
+    const uint16_t data_size) {
+    const char* value = flipper_format_seek_to_key(flipper_format, key);
+    if(!value) return false;
+
+    for(uint16_t i = 0; i < data_size; ++i) {
+        char* end;
+        data[i] = strtof(value, &end);
+        if(end == value) return false;
+        value = end;
+    }
+
+    return true;
+}
+
+bool flipper_format_write_float(
+    FlipperFormat* flipper_format,
+    const char* key,
+    const float* data,
+    const uint16_t data_size) {
+    furi_string_printf(flipper_format->line, "%s:", key);
+    for(uint16_t i = 0; i < data_size; ++i) {
+        furi_string_cat_printf(flipper_format->line, " %f", (double)data[i]);
+    }
+    return flipper_format_write_line(flipper_format);
+}
+
+bool flipper_format_write_comment_cstr(FlipperFormat* flipper_format, const char* data) {
+    furi_string_printf(flipper_format->line, "# %s", data);
+    return flipper_format_write_line(flipper_format);
+}
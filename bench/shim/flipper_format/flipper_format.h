@@ -0,0 +1,105 @@
+/**
+ * @file flipper_format.h
+ * @brief Host stand-in for flipper_format, reading and writing the same text format.
+ *
+ * Keys are searched for from the current position to the end of the stream, as in the
+ * firmware, so that the cost of skipping over other keys is the same.
+ */
+#pragma once
+
+#include <furi.h>
+#include <toolbox/stream/stream.h>
+
+/**
+ * @brief Storage opaque type declaration, unused on the host.
+ */
+typedef struct Storage Storage;
+
+/**
+ * @brief FlipperFormat opaque type declaration.
+ */
+typedef struct FlipperFormat FlipperFormat;
+
+FlipperFormat* flipper_format_string_alloc(void);
+
+FlipperFormat* flipper_format_file_alloc(Storage* storage);
+
+FlipperFormat* flipper_format_buffered_file_alloc(Storage* storage);
+
+bool flipper_format_file_open_existing(FlipperFormat* flipper_format, const char* path);
+
+bool flipper_format_file_open_always(FlipperFormat* flipper_format, const char* path);
+
+bool flipper_format_file_close(FlipperFormat* flipper_format);
+
+bool flipper_format_buffered_file_open_existing(FlipperFormat* flipper_format, const char* path);
+
+bool flipper_format_buffered_file_open_always(FlipperFormat* flipper_format, const char* path);
+
+bool flipper_format_buffered_file_close(FlipperFormat* flipper_format);
+
+void flipper_format_free(FlipperFormat* flipper_format);
+
+Stream* flipper_format_get_raw_stream(FlipperFormat* flipper_format);
+
+bool flipper_format_rewind(FlipperFormat* flipper_format);
+
+bool flipper_format_read_header(
+    FlipperFormat* flipper_format,
+    FuriString* filetype,
+    uint32_t* version);
+
+bool flipper_format_write_header_cstr(
+    FlipperFormat* flipper_format,
+    const char* filetype,
+    const uint32_t version);
+
+bool flipper_format_get_value_count(
+    FlipperFormat* flipper_format,
+    const char* key,
+    uint32_t* count);
+
+bool flipper_format_read_string(FlipperFormat* flipper_format, const char* key, FuriString* data);
+
+bool flipper_format_write_string_cstr(
+    FlipperFormat* flipper_format,
+    const char* key,
+    const char* data);
+
+bool flipper_format_read_hex(
+    FlipperFormat* flipper_format,
+    const char* key,
+    uint8_t* data,
+    const uint16_t data_size);
+
+bool flipper_format_write_hex(
+    FlipperFormat* flipper_format,
+    const char* key,
+    const uint8_t* data,
+    const uint16_t data_size);
+
+bool flipper_format_read_uint32(
+    FlipperFormat* flipper_format,
+    const char* key,
+    uint32_t* data,
+    const uint16_t data_size);
+
+bool flipper_format_write_uint32(
+    FlipperFormat* flipper_format,
+    const char* key,
+    const uint32_t* data,
+    const uint16_t data_size);
+
+bool flipper_format_read_float(
+    FlipperFormat* flipper_format,
+    const char* key,
+    float* data,
+    const uint16_t data_size);
+
+bool flipper_format_write_float(
+    FlipperFormat* flipper_format,
+    const char* key,
+    const float* data,
+    const uint16_t data_size);
+
+bool flipper_format_write_comment_cstr(FlipperFormat* flipper_format, const char* data);
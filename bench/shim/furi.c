@@ -0,0 +1,133 @@
+#include <furi.h>
+
+#include <stdarg.h>
+#include <time.h>
+
+struct FuriString {
+    char* data;
+    size_t size;
+    size_t capacity;
+};
+
+static void furi_string_reserve(FuriString* string, size_t size) {
+    if(size + 1 <= string->capacity) return;
+
+    while(string->capacity < size + 1) {
+        string->capacity *= 2;
+    }
+    string->data = realloc(string->data, string->capacity);
+    furi_check(string->data);
+}
+
+void furi_delay_ms(uint32_t milliseconds) {
+    const struct timespec delay = {
+        .tv_sec = milliseconds / 1000,
+        .tv_nsec = (long)(milliseconds % 1000) * 1000000,
+    };
+    nanosleep(&delay, NULL);
+}
+
+FuriString* furi_string_alloc(void) {
+    FuriString* string = malloc(sizeof(FuriString));
+    furi_check(string);
+
+    string->capacity = 16;
+    string->data = malloc(string->capacity);
+    furi_check(string->data);
+    string->data[0] = '\0';
+    string->size = 0;
+
+    return string;
+}
+
+static int furi_string_vcat_printf(FuriString* string, const char* format, va_list args) {
+    va_list copy;
+    va_copy(copy, args);
+    const int size = vsnprintf(NULL, 0, format, copy);
+    va_end(copy);
+
+    if(size > 0) {
+        furi_string_reserve(string, string->size + size);
+        vsnprintf(string->data + string->size, size + 1, format, args);
+        string->size += size;
+    }
+
+    return size;
+}
+
+FuriString* furi_string_alloc_printf(const char* format, ...) {
+    FuriString* string = furi_string_alloc();
+
+    va_list args;
+    va_start(args, format);
+    furi_string_vcat_printf(string, format, args);
+    va_end(args);
+
+    return string;
+}
+
+void furi_string_free(FuriString* string) {
+    free(string->data);
+    free(string);
+}
+
+void furi_string_reset(FuriString* string) {
+    string->data[0] = '\0';
+    string->size = 0;
+}
+
+void furi_string_set_str(FuriString* string, const char* cstr) {
+    furi_string_set_strn(string, cstr, strlen(cstr));
+}
+
+void furi_string_set_strn(FuriString* string, const char* cstr, size_t size) {
+    furi_string_reset(string);
+    furi_string_cat_strn(string, cstr, size);
+}
+
+void furi_string_cat_str(FuriString* string, const char* cstr) {
+    furi_string_cat_strn(string, cstr, strlen(cstr));
+}
+
+void furi_string_cat_strn(FuriString* string, const char* cstr, size_t size) {
+    furi_string_reserve(string, string->size + size);
+    memcpy(string->data + string->size, cstr, size);
+    string->size += size;
+    string->data[string->size] = '\0';
+}
+
+int furi_string_printf(FuriString* string, const char* format, ...) {
+    furi_string_reset(string);
+
+    va_list args;
+    va_start(args, format);
+    const int size = furi_string_vcat_printf(string, format, args);
+    va_end(args);
+
+    return size;
+}
+
+int furi_string_cat_printf(FuriString* string, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    const int size = furi_string_vcat_printf(string, format, args);
+    va_end(args);
+
+    return size;
+}
+
+const char* furi_string_get_cstr(const FuriString* string) {
+    return string->data;
+}
+
+size_t furi_string_size(const FuriString* string) {
+    return string->size;
+}
+
+bool furi_string_equal_str(const FuriString* string, const char* cstr) {
+    return strcmp(string->data, cstr) == 0;
+}
+
+bool furi_string_cmp(const FuriString* a, const FuriString* b) {
+    return a->size == b->size && memcmp(a->data, b->data, a->size) == 0;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file furi.h
+ * @brief Host stand-in for the parts of furi used by the signal library.
+ *
+ * Only what infrared_signal.c and the benchmark need is here, behaving like the firmware
+ * as far as they can tell.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <core/check.h>
+
+#define COUNT_OF(x) (sizeof(x) / sizeof(x[0]))
+
+#ifndef MIN
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif
+
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+#define UNUSED(x) (void)(x)
+
+#define FURI_LOG_E(tag, format, ...) fprintf(stderr, "[E][" tag "] " format "\n", ##__VA_ARGS__)
+#define FURI_LOG_W(tag, format, ...) fprintf(stderr, "[W][" tag "] " format "\n", ##__VA_ARGS__)
+#define FURI_LOG_I(tag, format, ...) fprintf(stderr, "[I][" tag "] " format "\n", ##__VA_ARGS__)
+#define FURI_LOG_D(tag, format, ...)
+#define FURI_LOG_T(tag, format, ...)
+
+void furi_delay_ms(uint32_t milliseconds);
+
+/**
+ * @brief FuriString opaque type declaration.
+ */
+typedef struct FuriString FuriString;
+
+FuriString* furi_string_alloc(void);
+
+FuriString* furi_string_alloc_printf(const char* format, ...)
+    __attribute__((format(printf, 1, 2)));
+
+void furi_string_free(FuriString* string);
+
+void furi_string_reset(FuriString* string);
+
+void furi_string_set_str(FuriString* string, const char* cstr);
+
+void furi_string_set_strn(FuriString* string, const char* cstr, size_t size);
+
+void furi_string_cat_str(FuriString* string, const char* cstr);
+
+void furi_string_cat_strn(FuriString* string, const char* cstr, size_t size);
+
+int furi_string_printf(FuriString* string, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+int furi_string_cat_printf(FuriString* string, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+const char* furi_string_get_cstr(const FuriString* string);
+
+size_t furi_string_size(const FuriString* string);
+
+bool furi_string_equal_str(const FuriString* string, const char* cstr);
+
+bool furi_string_cmp(const FuriString* a, const FuriString* b);
+
+static inline bool furi_string_equal_string(const FuriString* a, const FuriString* b) {
+    return furi_string_cmp(a, b);
+}
+
+// Same as in the firmware, the second argument may be a C string or a FuriString.
+#define furi_string_equal(a, b)                  \
+    _Generic((b),                                \
+        char*: furi_string_equal_str,            \
+        const char*: furi_string_equal_str,      \
+        FuriString*: furi_string_equal_string,   \
+        const FuriString*: furi_string_equal_string)(a, b)
@@ -0,0 +1,30 @@
+/**
+ * @file furi_hal_infrared.h
+ * @brief Host stand-in for asynchronous infrared transmission.
+ *
+ * The data callback is called from furi_hal_infrared_async_tx_start() until the last
+ * timing, so that signals are expanded as they would be from the transmit interrupt.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    FuriHalInfraredTxGetDataStateOk,
+    FuriHalInfraredTxGetDataStateDone,
+    FuriHalInfraredTxGetDataStateLastDone,
+} FuriHalInfraredTxGetDataState;
+
+typedef FuriHalInfraredTxGetDataState (
+    *FuriHalInfraredTxGetDataISRCallback)(void* context, uint32_t* duration, bool* level);
+
+void furi_hal_infrared_async_tx_set_data_isr_callback(
+    FuriHalInfraredTxGetDataISRCallback callback,
+    void* context);
+
+void furi_hal_infrared_async_tx_start(uint32_t freq, float duty_cycle);
+
+void furi_hal_infrared_async_tx_wait_termination(void);
+
+bool furi_hal_infrared_is_busy(void);
@@ -0,0 +1,164 @@
+#include <furi.h>
+#include <furi_hal_infrared.h>
+#include <infrared_transmit.h>
+
+typedef struct {
+    const char* name;
+    uint8_t address_length;
+    uint8_t command_length;
+    uint32_t frequency;
+    float duty_cycle;
+    size_t min_repeat_count;
+} InfraredProtocolSpec;
+
+// Same names, lengths and carriers as the firmware's encoders and decoders.
+static const InfraredProtocolSpec infrared_protocols[InfraredProtocolMAX] = {
+    [InfraredProtocolNEC] = {"NEC", 8, 8, 38000, 0.33f, 1},
+    [InfraredProtocolNECext] = {"NECext", 16, 16, 38000, 0.33f, 1},
+    [InfraredProtocolNEC42] = {"NEC42", 13, 8, 38000, 0.33f, 1},
+    [InfraredProtocolNEC42ext] = {"NEC42ext", 26, 16, 38000, 0.33f, 1},
+    [InfraredProtocolSamsung32] = {"Samsung32", 8, 8, 38000, 0.33f, 1},
+    [InfraredProtocolRC6] = {"RC6", 8, 8, 36000, 0.33f, 1},
+    [InfraredProtocolRC5] = {"RC5", 5, 6, 36000, 0.27f, 1},
+    [InfraredProtocolRC5X] = {"RC5X", 5, 7, 36000, 0.27f, 1},
+    [InfraredProtocolSIRC] = {"SIRC", 5, 7, 40000, 0.33f, 3},
+    [InfraredProtocolSIRC15] = {"SIRC15", 8, 7, 40000, 0.33f, 3},
+    [InfraredProtocolSIRC20] = {"SIRC20", 13, 7, 40000, 0.33f, 3},
+    [InfraredProtocolKaseikyo] = {"Kaseikyo", 26, 10, 37000, 0.33f, 1},
+    [InfraredProtocolRCA] = {"RCA", 4, 8, 38000, 0.33f, 1},
+};
+
+// Handlers carry no state, any non-NULL pointer will do.
+static uint8_t infrared_handler;
+
+static FuriHalInfraredTxGetDataISRCallback infrared_tx_callback;
+static void* infrared_tx_context;
+
+InfraredDecoderHandler* infrared_alloc_decoder(void) {
+    return (InfraredDecoderHandler*)&infrared_handler;
+}
+
+const InfraredMessage*
+    infrared_decode(InfraredDecoderHandler* handler, bool level, uint32_t duration) {
+    UNUSED(handler);
+    UNUSED(level);
+    UNUSED(duration);
+    return NULL;
+}
+
+const InfraredMessage* infrared_check_decoder_ready(InfraredDecoderHandler* handler) {
+    UNUSED(handler);
+    return NULL;
+}
+
+void infrared_free_decoder(InfraredDecoderHandler* handler) {
+    UNUSED(handler);
+}
+
+void infrared_reset_decoder(InfraredDecoderHandler* handler) {
+    UNUSED(handler);
+}
+
+InfraredEncoderHandler* infrared_alloc_encoder(void) {
+    return (InfraredEncoderHandler*)&infrared_handler;
+}
+
+void infrared_free_encoder(InfraredEncoderHandler* handler) {
+    UNUSED(handler);
+}
+
+InfraredStatus infrared_encode(InfraredEncoderHandler* handler, uint32_t* duration, bool* level) {
+    UNUSED(handler);
+    UNUSED(duration);
+    UNUSED(level);
+    return InfraredStatusError;
+}
+
+void infrared_reset_encoder(InfraredEncoderHandler* handler, const InfraredMessage* message) {
+    UNUSED(handler);
+    UNUSED(message);
+}
+
+bool infrared_is_protocol_valid(InfraredProtocol protocol) {
+    return protocol >= 0 && protocol < InfraredProtocolMAX;
+}
+
+const char* infrared_get_protocol_name(InfraredProtocol protocol) {
+    return infrared_is_protocol_valid(protocol) ? infrared_protocols[protocol].name : "Invalid";
+}
+
+InfraredProtocol infrared_get_protocol_by_name(const char* protocol_name) {
+    for(InfraredProtocol protocol = 0; protocol < InfraredProtocolMAX; ++protocol) {
+        if(strcmp(infrared_protocols[protocol].name, protocol_name) == 0) {
+            return protocol;
+        }
+    }
+    return InfraredProtocolUnknown;
+}
+
+uint8_t infrared_get_protocol_address_length(InfraredProtocol protocol) {
+    return infrared_is_protocol_valid(protocol) ? infrared_protocols[protocol].address_length :
+                                                  0;
+}
+
+uint8_t infrared_get_protocol_command_length(InfraredProtocol protocol) {
+    return infrared_is_protocol_valid(protocol) ? infrared_protocols[protocol].command_length :
+                                                  0;
+}
+
+uint32_t infrared_get_protocol_frequency(InfraredProtocol protocol) {
+    return infrared_is_protocol_valid(protocol) ? infrared_protocols[protocol].frequency : 0;
+}
+
+float infrared_get_protocol_duty_cycle(InfraredProtocol protocol) {
+    return infrared_is_protocol_valid(protocol) ? infrared_protocols[protocol].duty_cycle : 0;
+}
+
+size_t infrared_get_protocol_min_repeat_count(InfraredProtocol protocol) {
+    return infrared_is_protocol_valid(protocol) ? infrared_protocols[protocol].min_repeat_count :
+                                                  0;
+}
+
+void infrared_send_raw_ext(
+    const uint32_t timings[],
+    uint32_t timings_cnt,
+    bool start_from_mark,
+    uint32_t frequency,
+    float duty_cycle) {
+    UNUSED(timings);
+    UNUSED(timings_cnt);
+    UNUSED(start_from_mark);
+    UNUSED(frequency);
+    UNUSED(duty_cycle);
+}
+
+void infrared_send(const InfraredMessage* message, int times) {
+    UNUSED(message);
+    UNUSED(times);
+}
+
+void furi_hal_infrared_async_tx_set_data_isr_callback(
+    FuriHalInfraredTxGetDataISRCallback callback,
+    void* context) {
+    infrared_tx_callback = callback;
+    infrared_tx_context = context;
+}
+
+void furi_hal_infrared_async_tx_start(uint32_t freq, float duty_cycle) {
+    UNUSED(freq);
+    UNUSED(duty_cycle);
+    furi_check(infrared_tx_callback);
+
+    uint32_t duration;
+    bool level;
+    while(infrared_tx_callback(infrared_tx_context, &duration, &level) !=
+          FuriHalInfraredTxGetDataStateLastDone) {
+    }
+}
+
+void furi_hal_infrared_async_tx_wait_termination(void) {
+}
+
+bool furi_hal_infrared_is_busy(void) {
+    return false;
+}
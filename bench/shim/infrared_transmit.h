@@ -0,0 +1,16 @@
+/**
+ * @file infrared_transmit.h
+ * @brief Host stand-in for blocking infrared transmission, which sends nothing.
+ */
+#pragma once
+
+#include <infrared/encoder_decoder/infrared.h>
+
+void infrared_send_raw_ext(
+    const uint32_t timings[],
+    uint32_t timings_cnt,
+    bool start_from_mark,
+    uint32_t frequency,
+    float duty_cycle);
+
+void infrared_send(const InfraredMessage* message, int times);
@@ -0,0 +1,9 @@
+/**
+ * @file infrared_worker.h
+ * @brief Host stand-in for the infrared worker, of which only the limits are used.
+ */
+#pragma once
+
+#include <infrared/encoder_decoder/infrared.h>
+
+#define MAX_TIMINGS_AMOUNT 1024U
@@ -0,0 +1,166 @@
+#include <furi.h>
+#include <toolbox/stream/stream.h>
+
+#include <unistd.h>
+
+typedef enum {
+    StreamTypeString,
+    StreamTypeFile,
+} StreamType;
+
+struct Stream {
+    StreamType type;
+
+    // String streams
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+    size_t position;
+
+    // File streams
+    FILE* file;
+    bool writing;
+};
+
+static Stream* stream_alloc(StreamType type) {
+    Stream* stream = calloc(1, sizeof(Stream));
+    furi_check(stream);
+    stream->type = type;
+    return stream;
+}
+
+Stream* string_stream_alloc(void) {
+    return stream_alloc(StreamTypeString);
+}
+
+Stream* file_stream_alloc(void) {
+    return stream_alloc(StreamTypeFile);
+}
+
+bool file_stream_open(Stream* stream, const char* path, bool create) {
+    furi_assert(stream->type == StreamTypeFile);
+    file_stream_close(stream);
+
+    stream->file = fopen(path, create ? "w+b" : "r+b");
+    stream->writing = false;
+    return stream->file != NULL;
+}
+
+bool file_stream_close(Stream* stream) {
+    furi_assert(stream->type == StreamTypeFile);
+    if(!stream->file) return false;
+
+    const bool success = fclose(stream->file) == 0;
+    stream->file = NULL;
+    return success;
+}
+
+void stream_free(Stream* stream) {
+    if(stream->type == StreamTypeFile) {
+        file_stream_close(stream);
+    }
+    free(stream->data);
+    free(stream);
+}
+
+void stream_clean(Stream* stream) {
+    if(stream->type == StreamTypeString) {
+        stream->size = 0;
+        stream->position = 0;
+    } else if(stream->file) {
+        fflush(stream->file);
+        furi_check(ftruncate(fileno(stream->file), 0) == 0);
+        rewind(stream->file);
+    }
+}
+
+bool stream_eof(Stream* stream) {
+    return stream_tell(stream) >= stream_size(stream);
+}
+
+bool stream_seek(Stream* stream, int32_t offset, StreamOffset offset_type) {
+    if(stream->type == StreamTypeFile) {
+        if(!stream->file) return false;
+        static const int whence[] = {
+            [StreamOffsetFromCurrent] = SEEK_CUR,
+            [StreamOffsetFromStart] = SEEK_SET,
+            [StreamOffsetFromEnd] = SEEK_END,
+        };
+        return fseek(stream->file, offset, whence[offset_type]) == 0;
+    }
+
+    int64_t position = offset;
+    if(offset_type == StreamOffsetFromCurrent) {
+        position += stream->position;
+    } else if(offset_type == StreamOffsetFromEnd) {
+        position += stream->size;
+    }
+
+    // As in the firmware, seeking out of bounds stops at the bound and fails.
+    const bool success = position >= 0 && position <= (int64_t)stream->size;
+    stream->position = position < 0 ? 0 : MIN((size_t)position, stream->size);
+    return success;
+}
+
+size_t stream_tell(Stream* stream) {
+    if(stream->type == StreamTypeFile) {
+        return stream->file ? (size_t)ftell(stream->file) : 0;
+    }
+    return stream->position;
+}
+
+size_t stream_size(Stream* stream) {
+    if(stream->type == StreamTypeFile) {
+        if(!stream->file) return 0;
+        const long position = ftell(stream->file);
+        fseek(stream->file, 0, SEEK_END);
+        const long size = ftell(stream->file);
+        fseek(stream->file, position, SEEK_SET);
+        return size;
+    }
+    return stream->size;
+}
+
+bool stream_rewind(Stream* stream) {
+    return stream_seek(stream, 0, StreamOffsetFromStart);
+}
+
+size_t stream_read(Stream* stream, uint8_t* data, size_t size) {
+    if(stream->type == StreamTypeFile) {
+        if(!stream->file) return 0;
+        if(stream->writing) {
+            // stdio needs a seek when switching from writing to reading.
+            fseek(stream->file, 0, SEEK_CUR);
+            stream->writing = false;
+        }
+        return fread(data, 1, size, stream->file);
+    }
+
+    size = MIN(size, stream->size - stream->position);
+    memcpy(data, stream->data + stream->position, size);
+    stream->position += size;
+    return size;
+}
+
+size_t stream_write(Stream* stream, const uint8_t* data, size_t size) {
+    if(stream->type == StreamTypeFile) {
+        if(!stream->file) return 0;
+        if(!stream->writing) {
+            fseek(stream->file, 0, SEEK_CUR);
+            stream->writing = true;
+        }
+        return fwrite(data, 1, size, stream->file);
+    }
+
+    const size_t end = stream->position + size;
+    if(end > stream->capacity) {
+        stream->capacity = MAX(end, stream->capacity * 2);
+        stream->data = realloc(stream->data, stream->capacity);
+        furi_check(stream->data);
+    }
+
+    memcpy(stream->data + stream->position, data, size);
+    stream->position = end;
+    stream->size = MAX(stream->size, end);
+    return size;
+}
@@ -0,0 +1,66 @@
+/**
+ * @file stream.h
+ * @brief Host stand-in for toolbox streams, backed by memory or a stdio file.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Stream opaque type declaration.
+ */
+typedef struct Stream Stream;
+
+typedef enum {
+    StreamOffsetFromCurrent,
+    StreamOffsetFromStart,
+    StreamOffsetFromEnd,
+} StreamOffset;
+
+/**
+ * @brief Allocate a stream held in memory.
+ * @returns pointer to the created instance.
+ */
+Stream* string_stream_alloc(void);
+
+/**
+ * @brief Allocate a stream over a file, closed until file_stream_open() succeeds.
+ * @returns pointer to the created instance.
+ */
+Stream* file_stream_alloc(void);
+
+/**
+ * @brief Open a file, either an existing one or a new, empty one.
+ * @param[in,out] stream pointer to a stream made by file_stream_alloc().
+ * @param[in] path path of the file on the host.
+ * @param[in] create whether the file is created, or truncated if it exists.
+ * @returns true if the file could be opened, false otherwise.
+ */
+bool file_stream_open(Stream* stream, const char* path, bool create);
+
+/**
+ * @brief Close the file of a stream, if any.
+ * @param[in,out] stream pointer to a stream made by file_stream_alloc().
+ * @returns true if the file was written out, false otherwise.
+ */
+bool file_stream_close(Stream* stream);
+
+void stream_free(Stream* stream);
+
+void stream_clean(Stream* stream);
+
+bool stream_eof(Stream* stream);
+
+bool stream_seek(Stream* stream, int32_t offset, StreamOffset offset_type);
+
+size_t stream_tell(Stream* stream);
+
+size_t stream_size(Stream* stream);
+
+bool stream_rewind(Stream* stream);
+
+size_t stream_read(Stream* stream, uint8_t* data, size_t size);
+
+size_t stream_write(Stream* stream, const uint8_t* data, size_t size);
@@ -0,0 +1,280 @@
+/**
+ * @file signal_bench.c
+ * @brief Host benchmarks of the signal library.
+ *
+ * Synthetic .ir files of 10 to 10,000 signals are written, one in 16 being raw with up to
+ * MAX_TIMINGS_AMOUNT timings, then read back in the ways the app and the Infrared app do.
+ * The time taken by each operation is printed, e.g. to compare builds before and after a
+ * change.
+ *
+ * Run with: make -C bench run
+ */
+#include "infrared_signal.h"
+
+#include <furi.h>
+#include <flipper_format/flipper_format.h>
+#include <infrared_worker.h>
+
+#include <time.h>
+
+#define TAG "SignalBench"
+
+#define BENCH_FILE_TYPE "IR signals file"
+#define BENCH_FILE_VERSION 1
+
+#define BENCH_RAW_PERIOD 16 // One signal in this many is raw
+#define BENCH_SET_RAW_ITERATIONS 1000
+
+static const char* bench_path = "bench.ir";
+static const size_t bench_sizes[] = {10, 100, 1000, 10000};
+
+static uint64_t bench_get_time_us(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+// Raw signals cycle through 1024, 512, 256 and 128 timings (for MAX_TIMINGS_AMOUNT = 1024).
+static size_t bench_get_raw_size(size_t index) {
+    return MAX_TIMINGS_AMOUNT >> ((index / BENCH_RAW_PERIOD) % 4);
+}
+
+static void bench_fill_timings(uint32_t* timings, size_t timings_size) {
+    for(size_t i = 0; i < timings_size; ++i) {
+        timings[i] = 500 + (i % 3) * 500;
+    }
+}
+
+static void bench_set_signal(InfraredSignal* signal, uint32_t* timings, size_t index) {
+    if(index % BENCH_RAW_PERIOD == 0) {
+        const size_t timings_size = bench_get_raw_size(index);
+        bench_fill_timings(timings, timings_size);
+        infrared_signal_set_raw_signal(signal, timings, timings_size, 38000, 0.33f);
+    } else {
+        const InfraredMessage message = {
+            .protocol = InfraredProtocolNECext,
+            .address = index & 0xFFFF,
+            .command = (index >> 16) & 0xFFFF,
+            .repeat = false,
+        };
+        infrared_signal_set_message(signal, &message);
+    }
+}
+
+static void bench_report(const char* operation, size_t count, uint64_t start) {
+    const uint64_t elapsed = bench_get_time_us() - start;
+    printf(
+        "%6zu signals: %-20s %8llu.%03llu ms\n",
+        count,
+        operation,
+        (unsigned long long)(elapsed / 1000),
+        (unsigned long long)(elapsed % 1000));
+}
+
+// Write the synthetic file, timing the save.
+static bool bench_write(FlipperFormat* ff, size_t count) {
+    InfraredSignal* signal = infrared_signal_alloc();
+    uint32_t* timings = malloc(MAX_TIMINGS_AMOUNT * sizeof(uint32_t));
+    FuriString* name = furi_string_alloc();
+    bool success = false;
+
+    do {
+        if(!flipper_format_buffered_file_open_always(ff, bench_path)) break;
+        if(!flipper_format_write_header_cstr(ff, BENCH_FILE_TYPE, BENCH_FILE_VERSION)) break;
+
+        const uint64_t start = bench_get_time_us();
+        InfraredSignalWriter* writer = infrared_signal_writer_alloc(ff);
+        bool signals_ok = true;
+        for(size_t i = 0; signals_ok && i < count; ++i) {
+            bench_set_signal(signal, timings, i);
+            furi_string_printf(name, "Sig_%zu", i);
+            signals_ok = infrared_signal_writer_add(writer, signal, furi_string_get_cstr(name));
+        }
+        signals_ok = signals_ok && infrared_signal_writer_flush(writer);
+        infrared_signal_writer_free(writer);
+        if(!signals_ok) break;
+
+        bench_report("save", count, start);
+        success = true;
+    } while(false);
+
+    flipper_format_buffered_file_close(ff);
+    furi_string_free(name);
+    free(timings);
+    infrared_signal_free(signal);
+
+    return success;
+}
+
+// Go back to the first signal of the synthetic file, right after its header.
+static bool bench_rewind(FlipperFormat* ff, FuriString* tmp) {
+    uint32_t version;
+    return flipper_format_rewind(ff) && flipper_format_read_header(ff, tmp, &version);
+}
+
+static bool bench_open(FlipperFormat* ff, FuriString* tmp) {
+    return flipper_format_buffered_file_open_existing(ff, bench_path) && bench_rewind(ff, tmp);
+}
+
+static bool bench_read(FlipperFormat* ff, size_t count) {
+    InfraredSignal* signal = infrared_signal_alloc();
+    FuriString* name = furi_string_alloc();
+    FuriString* last_name = furi_string_alloc_printf("Sig_%zu", count - 1);
+    bool success = false;
+
+    do {
+        if(!bench_open(ff, name)) break;
+
+        uint64_t start = bench_get_time_us();
+        size_t read = 0;
+        while(infrared_signal_read(signal, ff, name)) {
+            read++;
+        }
+        bench_report("read", count, start);
+        if(read != count) {
+            FURI_LOG_E(TAG, "Read %zu signals out of %zu", read, count);
+            break;
+        }
+
+        // The last signal is the worst case for both searches.
+        bench_rewind(ff, name);
+        start = bench_get_time_us();
+        if(!infrared_signal_search_by_name_and_read(signal, ff, furi_string_get_cstr(last_name))) {
+            FURI_LOG_E(TAG, "Signal not found: %s", furi_string_get_cstr(last_name));
+            break;
+        }
+        bench_report("search_by_name", count, start);
+
+        bench_rewind(ff, name);
+        start = bench_get_time_us();
+        if(!infrared_signal_search_by_index_and_read(signal, ff, count - 1)) {
+            FURI_LOG_E(TAG, "Signal not found: %zu", count - 1);
+            break;
+        }
+        bench_report("search_by_index", count, start);
+
+        success = true;
+    } while(false);
+
+    flipper_format_buffered_file_close(ff);
+    furi_string_free(last_name);
+    furi_string_free(name);
+    infrared_signal_free(signal);
+
+    return success;
+}
+
+static bool bench_index(FlipperFormat* ff, size_t count) {
+    InfraredSignal* signal = infrared_signal_alloc();
+    InfraredSignalIndex* index = infrared_signal_index_alloc();
+    FuriString* name = furi_string_alloc();
+    bool success = false;
+
+    do {
+        if(!bench_open(ff, name)) break;
+        furi_string_printf(name, "Sig_%zu", count - 1);
+
+        uint64_t start = bench_get_time_us();
+        if(infrared_signal_index_build(index, ff) != count) {
+            FURI_LOG_E(
+                TAG,
+                "Indexed %zu signals out of %zu",
+                infrared_signal_index_get_count(index),
+                count);
+            break;
+        }
+        bench_report("index_build", count, start);
+
+        start = bench_get_time_us();
+        if(!infrared_signal_index_read_by_name(index, signal, ff, furi_string_get_cstr(name))) {
+            FURI_LOG_E(TAG, "Signal not found: %s", furi_string_get_cstr(name));
+            break;
+        }
+        bench_report("index_read_by_name", count, start);
+
+        // A name with the right length and no signal behind it, to time a miss.
+        start = bench_get_time_us();
+        if(infrared_signal_index_read_by_name(index, signal, ff, "Sig_x")) {
+            FURI_LOG_E(TAG, "Signal found: Sig_x");
+            break;
+        }
+        bench_report("index_miss", count, start);
+
+        success = true;
+    } while(false);
+
+    flipper_format_buffered_file_close(ff);
+    furi_string_free(name);
+    infrared_signal_index_free(index);
+    infrared_signal_free(signal);
+
+    return success;
+}
+
+static bool bench_library(FlipperFormat* ff, size_t count) {
+    InfraredSignalLibrary* library = infrared_signal_library_alloc();
+    FuriString* tmp = furi_string_alloc();
+    bool success = false;
+
+    do {
+        if(!bench_open(ff, tmp)) break;
+
+        const uint64_t start = bench_get_time_us();
+        if(!infrared_signal_library_load(library, ff) ||
+           infrared_signal_library_get_count(library) != count) {
+            FURI_LOG_E(TAG, "Could not load %zu signals", count);
+            break;
+        }
+        bench_report("library_load", count, start);
+
+        success = true;
+    } while(false);
+
+    flipper_format_buffered_file_close(ff);
+    furi_string_free(tmp);
+    infrared_signal_library_free(library);
+
+    return success;
+}
+
+static void bench_set_raw_signal(void) {
+    InfraredSignal* signal = infrared_signal_alloc();
+    uint32_t* timings = malloc(MAX_TIMINGS_AMOUNT * sizeof(uint32_t));
+    bench_fill_timings(timings, MAX_TIMINGS_AMOUNT);
+
+    const uint64_t start = bench_get_time_us();
+    for(size_t i = 0; i < BENCH_SET_RAW_ITERATIONS; ++i) {
+        infrared_signal_set_raw_signal(signal, timings, MAX_TIMINGS_AMOUNT, 38000, 0.33f);
+    }
+    bench_report("set_raw_signal", BENCH_SET_RAW_ITERATIONS, start);
+
+    free(timings);
+    infrared_signal_free(signal);
+}
+
+int main(int argc, char* argv[]) {
+    if(argc > 1) {
+        bench_path = argv[1];
+    }
+
+    FlipperFormat* ff = flipper_format_buffered_file_alloc(NULL);
+    bool success = true;
+
+    bench_set_raw_signal();
+
+    for(size_t i = 0; success && i < COUNT_OF(bench_sizes); ++i) {
+        const size_t count = bench_sizes[i];
+        if(!bench_write(ff, count)) {
+            FURI_LOG_E(TAG, "Could not write %s", bench_path);
+            success = false;
+            break;
+        }
+
+        success = bench_read(ff, count) && bench_index(ff, count) && bench_library(ff, count);
+    }
+
+    remove(bench_path);
+    flipper_format_free(ff);
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -3,8 +3,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <core/check.h>
+#include <toolbox/stream/stream.h>
 #include <infrared_worker.h>
 #include <infrared_transmit.h>
+#include <furi_hal_infrared.h>
 
 #define TAG "InfraredSignal"
 
@@ -21,6 +23,19 @@
 #define INFRARED_SIGNAL_FREQUENCY_KEY "frequency"
 #define INFRARED_SIGNAL_DUTY_CYCLE_KEY "duty_cycle"
 
+// Compact timings escape code, followed by the high and low halves of a long timing
+#define INFRARED_SIGNAL_COMPACT_ESCAPE UINT16_MAX
+
+// Serialized signals are written out to the file in chunks of this size
+#define INFRARED_SIGNAL_WRITER_CHUNK_SIZE 2048
+
+// Silence between the transmissions of a held raw signal, as the infrared worker uses
+#define INFRARED_SIGNAL_RAW_REPEAT_DELAY_MS 150
+
+// Largest differences allowed between a raw signal and its decoded message
+#define INFRARED_SIGNAL_CANONICAL_FREQUENCY_TOLERANCE 2000 // Hz
+#define INFRARED_SIGNAL_CANONICAL_TIMING_TOLERANCE 25 // Percent
+
 // Parsed signal keys
 #define INFRARED_SIGNAL_PROTOCOL_KEY "protocol"
 #define INFRARED_SIGNAL_ADDRESS_KEY "address"
@@ -28,18 +43,132 @@
 
 struct InfraredSignal {
     bool is_raw;
+    bool is_static; // Raw timings point to constant memory that must not be freed.
     union {
         InfraredMessage message;
         InfraredRawSignal raw;
     } payload;
+    InfraredRawSignal compiled; // Pre-encoded timings of a parsed signal, if any.
+    InfraredRawSignal compiled_repeat; // One repeat frame to follow the compiled timings.
+    uint16_t* compact; // Compact raw timings, replacing payload.raw.timings if set.
+    size_t compact_size; // Number of elements in the compact array.
+};
+
+typedef struct {
+    uint32_t name_hash;
+    uint32_t name_length;
+    uint32_t position; // Signal index in the file.
+    uint32_t name_offset; // Stream position of the signal name, to check it on lookup.
+    uint32_t offset; // Stream position right after the signal name, i.e. its body.
+} InfraredSignalIndexEntry;
+
+struct InfraredSignalIndex {
+    InfraredSignalIndexEntry* entries; // In file order.
+    InfraredSignalIndexEntry* sorted; // Sorted by name hash, then by file order.
+    size_t count;
+};
+
+typedef struct {
+    uint32_t address;
+    uint32_t command;
+} InfraredSignalProtocolMasks;
+
+struct InfraredSignalWriter {
+    FlipperFormat* ff; // Destination file.
+    FlipperFormat* buffer; // Signals serialized so far, not yet written out.
+    uint8_t* chunk;
+};
+
+struct InfraredSignalParser {
+    FuriString* name; // Signal names read while searching.
+    FuriString* value; // String values read from signal bodies.
 };
 
+struct InfraredSignalLibrary {
+    void* arena; // Signals, name pointers, raw timings and names, in this order.
+    InfraredSignal* signals;
+    const char** names;
+    size_t count;
+    uint32_t* message_slots; // Open addressing table of parsed signal indices + 1, 0 if empty.
+    size_t message_slots_size; // Power of two, or 0.
+};
+
+typedef struct {
+    const InfraredSignal* const* signals;
+    const uint32_t* gaps;
+    size_t count;
+    size_t signal_index; // Signal being transmitted.
+    size_t timing_index; // Next timing of a raw or compiled signal.
+    size_t compact_index; // Next element of compact raw timings.
+    size_t frames_left; // Frames left to encode of an uncompiled parsed signal.
+    size_t repeats_left; // Compiled repeat frames left to send after the compiled timings.
+    size_t times; // Number of frames each signal is sent with.
+    bool in_gap; // The gap after the current signal is due next.
+    bool failed; // Encoding failed, the transmission was cut short.
+    InfraredEncoderHandler* encoder;
+    uint32_t pending_duration; // Timing read ahead, to merge adjacent same-level timings.
+    bool pending_level;
+} InfraredSignalBurst;
+
+static bool infrared_signal_transmit_frames(
+    const InfraredSignal* const* signals,
+    const uint32_t* gaps,
+    size_t count,
+    size_t times);
+
 static void infrared_signal_clear_timings(InfraredSignal* signal) {
     if(signal->is_raw) {
-        free(signal->payload.raw.timings);
+        if(!signal->is_static) {
+            free(signal->payload.raw.timings);
+        }
+        signal->is_static = false;
         signal->payload.raw.timings_size = 0;
         signal->payload.raw.timings = NULL;
+
+        free(signal->compact);
+        signal->compact_size = 0;
+        signal->compact = NULL;
+    }
+
+    free(signal->compiled.timings);
+    signal->compiled.timings_size = 0;
+    signal->compiled.timings = NULL;
+
+    free(signal->compiled_repeat.timings);
+    signal->compiled_repeat.timings_size = 0;
+    signal->compiled_repeat.timings = NULL;
+}
+
+static void infrared_signal_copy_timings(InfraredRawSignal* dst, const InfraredRawSignal* src) {
+    *dst = *src;
+    if(src->timings) {
+        dst->timings = malloc(src->timings_size * sizeof(uint32_t));
+        memcpy(dst->timings, src->timings, src->timings_size * sizeof(uint32_t));
+    }
+}
+
+static uint32_t infrared_signal_length_to_mask(uint32_t length) {
+    return length < 32 ? (1UL << length) - 1 : UINT32_MAX;
+}
+
+// Address and command masks of each protocol, built on first use.
+static const InfraredSignalProtocolMasks* infrared_signal_get_protocol_masks(void) {
+    static InfraredSignalProtocolMasks masks[InfraredProtocolMAX];
+    static bool masks_ready = false;
+
+    // Concurrent first calls would only write the same values twice.
+    if(!masks_ready) {
+        for(int i = 0; i < InfraredProtocolMAX; ++i) {
+            const InfraredProtocol protocol = (InfraredProtocol)i;
+            masks[i].address =
+                infrared_signal_length_to_mask(infrared_get_protocol_address_length(protocol));
+            masks[i].command =
+                infrared_signal_length_to_mask(infrared_get_protocol_command_length(protocol));
+        }
+        masks_ready = true;
     }
+
+    return masks;
 }
 
 static bool infrared_signal_is_message_valid(const InfraredMessage* message) {
@@ -48,8 +177,9 @@ static bool infrared_signal_is_message_valid(const InfraredMessage* message) {
         return false;
     }
 
-    uint32_t address_length = infrared_get_protocol_address_length(message->protocol);
-    uint32_t address_mask = (1UL << address_length) - 1;
+    const InfraredSignalProtocolMasks* masks =
+        &infrared_signal_get_protocol_masks()[message->protocol];
+    const uint32_t address_mask = masks->address;
 
     if(message->address != (message->address & address_mask)) {
         FURI_LOG_E(
@@ -60,8 +190,7 @@ static bool infrared_signal_is_message_valid(const InfraredMessage* message) {
         return false;
     }
 
-    uint32_t command_length = infrared_get_protocol_command_length(message->protocol);
-    uint32_t command_mask = (1UL << command_length) - 1;
+    const uint32_t command_mask = masks->command;
 
     if(message->command != (message->command & command_mask)) {
         FURI_LOG_E(
@@ -123,9 +252,8 @@ static inline bool infrared_signal_save_raw(const InfraredRawSignal* raw, Flippe
                ff, INFRARED_SIGNAL_DATA_KEY, raw->timings, raw->timings_size);
 }
 
-static inline bool infrared_signal_read_message(InfraredSignal* signal, FlipperFormat* ff) {
-    FuriString* buf;
-    buf = furi_string_alloc();
+static inline bool
+    infrared_signal_read_message(InfraredSignal* signal, FlipperFormat* ff, FuriString* buf) {
     bool success = false;
 
     do {
@@ -144,32 +272,39 @@ static inline bool infrared_signal_read_message(InfraredSignal* signal, FlipperF
         success = true;
     } while(false);
 
-    furi_string_free(buf);
     return success;
 }
 
-static inline bool infrared_signal_read_raw(InfraredSignal* signal, FlipperFormat* ff) {
-    bool success = false;
+// Read everything about a raw signal but its timings, which are left for the caller to store.
+static inline bool infrared_signal_read_raw_header(InfraredRawSignal* raw, FlipperFormat* ff) {
+    uint32_t timings_size;
 
-    do {
-        uint32_t frequency;
-        if(!flipper_format_read_uint32(ff, INFRARED_SIGNAL_FREQUENCY_KEY, &frequency, 1)) break;
+    if(!flipper_format_read_uint32(ff, INFRARED_SIGNAL_FREQUENCY_KEY, &raw->frequency, 1) ||
+       !flipper_format_read_float(ff, INFRARED_SIGNAL_DUTY_CYCLE_KEY, &raw->duty_cycle, 1) ||
+       !flipper_format_get_value_count(ff, INFRARED_SIGNAL_DATA_KEY, &timings_size) ||
+       timings_size > MAX_TIMINGS_AMOUNT) {
+        return false;
+    }
 
-        float duty_cycle;
-        if(!flipper_format_read_float(ff, INFRARED_SIGNAL_DUTY_CYCLE_KEY, &duty_cycle, 1)) break;
+    raw->timings = NULL;
+    raw->timings_size = timings_size;
+    return true;
+}
 
-        uint32_t timings_size;
-        if(!flipper_format_get_value_count(ff, INFRARED_SIGNAL_DATA_KEY, &timings_size)) break;
+static inline bool infrared_signal_read_raw(InfraredSignal* signal, FlipperFormat* ff) {
+    bool success = false;
 
-        if(timings_size > MAX_TIMINGS_AMOUNT) break;
+    do {
+        InfraredRawSignal raw;
+        if(!infrared_signal_read_raw_header(&raw, ff)) break;
 
-        uint32_t* timings = malloc(sizeof(uint32_t) * timings_size);
-        if(!flipper_format_read_uint32(ff, INFRARED_SIGNAL_DATA_KEY, timings, timings_size)) {
+        uint32_t* timings = malloc(sizeof(uint32_t) * raw.timings_size);
+        if(!flipper_format_read_uint32(ff, INFRARED_SIGNAL_DATA_KEY, timings, raw.timings_size)) {
             free(timings);
             break;
         }
-        infrared_signal_set_raw_signal(signal, timings, timings_size, frequency, duty_cycle);
-        free(timings);
+        infrared_signal_adopt_raw_signal(
+            signal, timings, raw.timings_size, raw.frequency, raw.duty_cycle);
 
         success = true;
     } while(false);
@@ -177,9 +312,7 @@ static inline bool infrared_signal_read_raw(InfraredSignal* signal, FlipperForma
     return success;
 }
 
-bool infrared_signal_read_body(InfraredSignal* signal, FlipperFormat* ff) {
-    FuriString* tmp = furi_string_alloc();
-
+static bool infrared_signal_read_body_ex(InfraredSignal* signal, FlipperFormat* ff, FuriString* tmp) {
     bool success = false;
 
     do {
@@ -188,7 +321,7 @@ bool infrared_signal_read_body(InfraredSignal* signal, FlipperFormat* ff) {
         if(furi_string_equal(tmp, INFRARED_SIGNAL_TYPE_RAW)) {
             if(!infrared_signal_read_raw(signal, ff)) break;
         } else if(furi_string_equal(tmp, INFRARED_SIGNAL_TYPE_PARSED)) {
-            if(!infrared_signal_read_message(signal, ff)) break;
+            if(!infrared_signal_read_message(signal, ff, tmp)) break;
         } else {
             FURI_LOG_E(TAG, "Unknown signal type: %s", furi_string_get_cstr(tmp));
             break;
@@ -197,16 +330,53 @@ bool infrared_signal_read_body(InfraredSignal* signal, FlipperFormat* ff) {
         success = true;
     } while(false);
 
+    return success;
+}
+
+bool infrared_signal_read_body(InfraredSignal* signal, FlipperFormat* ff) {
+    FuriString* tmp = furi_string_alloc();
+    const bool success = infrared_signal_read_body_ex(signal, ff, tmp);
     furi_string_free(tmp);
     return success;
 }
 
-InfraredSignal* infrared_signal_alloc(void) {
-    InfraredSignal* signal = malloc(sizeof(InfraredSignal));
+InfraredSignalParser* infrared_signal_parser_alloc(void) {
+    InfraredSignalParser* parser = malloc(sizeof(InfraredSignalParser));
+
+    parser->name = furi_string_alloc();
+    parser->value = furi_string_alloc();
 
+    return parser;
+}
+
+void infrared_signal_parser_free(InfraredSignalParser* parser) {
+    furi_string_free(parser->name);
+    furi_string_free(parser->value);
+    free(parser);
+}
+
+bool infrared_signal_read_body_ctx(
+    InfraredSignalParser* parser,
+    InfraredSignal* signal,
+    FlipperFormat* ff) {
+    return infrared_signal_read_body_ex(signal, ff, parser->value);
+}
+
+static void infrared_signal_init(InfraredSignal* signal) {
     signal->is_raw = false;
+    signal->is_static = false;
     signal->payload.message.protocol = InfraredProtocolUnknown;
+    signal->compiled.timings_size = 0;
+    signal->compiled.timings = NULL;
+    signal->compiled_repeat.timings_size = 0;
+    signal->compiled_repeat.timings = NULL;
+    signal->compact_size = 0;
+    signal->compact = NULL;
+}
 
+InfraredSignal* infrared_signal_alloc(void) {
+    InfraredSignal* signal = malloc(sizeof(InfraredSignal));
+    infrared_signal_init(signal);
     return signal;
 }
 
@@ -225,13 +395,29 @@ bool infrared_signal_is_valid(const InfraredSignal* signal) {
 }
 
 void infrared_signal_set_signal(InfraredSignal* signal, const InfraredSignal* other) {
-    if(other->is_raw) {
+    if(other->is_raw && other->is_static) {
+        // Constant timings outlive every instance, so they can be shared.
+        const InfraredRawSignal* raw = &other->payload.raw;
+        infrared_signal_set_raw_signal_static(
+            signal, raw->timings, raw->timings_size, raw->frequency, raw->duty_cycle);
+    } else if(other->is_raw && other->compact) {
+        infrared_signal_clear_timings(signal);
+
+        signal->is_raw = true;
+        signal->payload.raw = other->payload.raw;
+        signal->compact_size = other->compact_size;
+        signal->compact = malloc(other->compact_size * sizeof(uint16_t));
+        memcpy(signal->compact, other->compact, other->compact_size * sizeof(uint16_t));
+    } else if(other->is_raw) {
         const InfraredRawSignal* raw = &other->payload.raw;
         infrared_signal_set_raw_signal(
             signal, raw->timings, raw->timings_size, raw->frequency, raw->duty_cycle);
     } else {
         const InfraredMessage* message = &other->payload.message;
         infrared_signal_set_message(signal, message);
+
+        infrared_signal_copy_timings(&signal->compiled, &other->compiled);
+        infrared_signal_copy_timings(&signal->compiled_repeat, &other->compiled_repeat);
     }
 }
 
@@ -241,6 +427,18 @@ void infrared_signal_set_raw_signal(
     size_t timings_size,
     uint32_t frequency,
     float duty_cycle) {
+    uint32_t* timings_copy = malloc(timings_size * sizeof(uint32_t));
+    memcpy(timings_copy, timings, timings_size * sizeof(uint32_t));
+
+    infrared_signal_adopt_raw_signal(signal, timings_copy, timings_size, frequency, duty_cycle);
+}
+
+void infrared_signal_adopt_raw_signal(
+    InfraredSignal* signal,
+    uint32_t* timings,
+    size_t timings_size,
+    uint32_t frequency,
+    float duty_cycle) {
     infrared_signal_clear_timings(signal);
 
     signal->is_raw = true;
@@ -248,13 +446,102 @@ void infrared_signal_set_raw_signal(
     signal->payload.raw.timings_size = timings_size;
     signal->payload.raw.frequency = frequency;
     signal->payload.raw.duty_cycle = duty_cycle;
+    signal->payload.raw.timings = timings;
+}
 
-    signal->payload.raw.timings = malloc(timings_size * sizeof(uint32_t));
-    memcpy(signal->payload.raw.timings, timings, timings_size * sizeof(uint32_t));
+void infrared_signal_set_raw_signal_static(
+    InfraredSignal* signal,
+    const uint32_t* timings,
+    size_t timings_size,
+    uint32_t frequency,
+    float duty_cycle) {
+    // The timings are never written to nor freed, the cast only satisfies InfraredRawSignal.
+    infrared_signal_adopt_raw_signal(
+        signal, (uint32_t*)timings, timings_size, frequency, duty_cycle);
+    signal->is_static = true;
+}
+
+bool infrared_signal_is_static(const InfraredSignal* signal) {
+    return signal->is_raw && signal->is_static;
+}
+
+static inline uint32_t infrared_signal_compact_read(const uint16_t* compact, size_t* index) {
+    uint32_t timing = compact[(*index)++];
+    if(timing == INFRARED_SIGNAL_COMPACT_ESCAPE) {
+        timing = ((uint32_t)compact[*index] << 16) | compact[*index + 1];
+        *index += 2;
+    }
+    return timing;
+}
+
+static uint32_t* infrared_signal_expand_compact(const InfraredSignal* signal) {
+    uint32_t* timings = malloc(signal->payload.raw.timings_size * sizeof(uint32_t));
+
+    size_t index = 0;
+    for(size_t i = 0; i < signal->payload.raw.timings_size; ++i) {
+        timings[i] = infrared_signal_compact_read(signal->compact, &index);
+    }
+
+    return timings;
+}
+
+bool infrared_signal_compact(InfraredSignal* signal) {
+    if(!signal->is_raw || signal->is_static || signal->compact) {
+        return signal->compact != NULL;
+    }
+
+    const InfraredRawSignal* raw = &signal->payload.raw;
+
+    size_t compact_size = 0;
+    for(size_t i = 0; i < raw->timings_size; ++i) {
+        compact_size += raw->timings[i] < INFRARED_SIGNAL_COMPACT_ESCAPE ? 1 : 3;
+    }
+
+    // Signals made mostly of long timings would only grow.
+    if(compact_size * sizeof(uint16_t) >= raw->timings_size * sizeof(uint32_t)) {
+        return false;
+    }
+
+    uint16_t* compact = malloc(compact_size * sizeof(uint16_t));
+    size_t index = 0;
+
+    for(size_t i = 0; i < raw->timings_size; ++i) {
+        const uint32_t timing = raw->timings[i];
+        if(timing < INFRARED_SIGNAL_COMPACT_ESCAPE) {
+            compact[index++] = timing;
+        } else {
+            compact[index++] = INFRARED_SIGNAL_COMPACT_ESCAPE;
+            compact[index++] = timing >> 16;
+            compact[index++] = timing & UINT16_MAX;
+        }
+    }
+
+    free(signal->payload.raw.timings);
+    signal->payload.raw.timings = NULL;
+    signal->compact = compact;
+    signal->compact_size = compact_size;
+
+    return true;
+}
+
+bool infrared_signal_is_compact(const InfraredSignal* signal) {
+    return signal->compact != NULL;
+}
+
+void infrared_signal_expand(InfraredSignal* signal) {
+    if(!signal->compact) return;
+
+    signal->payload.raw.timings = infrared_signal_expand_compact(signal);
+
+    free(signal->compact);
+    signal->compact = NULL;
+    signal->compact_size = 0;
 }
 
 const InfraredRawSignal* infrared_signal_get_raw_signal(const InfraredSignal* signal) {
     furi_assert(signal->is_raw);
+    // Checked in release builds too, compact signals have no timings array to return.
+    furi_check(!signal->compact);
     return &signal->payload.raw;
 }
 
@@ -270,10 +557,341 @@ const InfraredMessage* infrared_signal_get_message(const InfraredSignal* signal)
     return &signal->payload.message;
 }
 
+// Encode a number of frames, merging adjacent timings of the same level.
+static size_t infrared_signal_encode_frames(
+    InfraredEncoderHandler* encoder,
+    size_t frames,
+    bool skip_leading_space,
+    uint32_t* timings,
+    bool* first_level) {
+    size_t timings_size = 0;
+    bool last_level = false;
+
+    while(frames) {
+        uint32_t duration;
+        bool level;
+
+        const InfraredStatus status = infrared_encode(encoder, &duration, &level);
+        if(status == InfraredStatusError) {
+            FURI_LOG_E(TAG, "Failed to encode signal");
+            return 0;
+        }
+
+        if(timings_size == 0 && !level && skip_leading_space) {
+            // Raw timings always start from a mark, leading silence is dropped.
+        } else if(timings_size > 0 && level == last_level) {
+            timings[timings_size - 1] += duration;
+        } else if(timings_size < MAX_TIMINGS_AMOUNT) {
+            if(timings_size == 0) {
+                *first_level = level;
+            }
+            timings[timings_size++] = duration;
+            last_level = level;
+        } else {
+            FURI_LOG_E(TAG, "Encoded signal is too long");
+            return 0;
+        }
+
+        if(status == InfraredStatusDone) {
+            frames--;
+        }
+    }
+
+    return timings_size;
+}
+
+bool infrared_signal_compile(InfraredSignal* signal) {
+    if(signal->is_raw || signal->compiled.timings) {
+        return true;
+    }
+
+    const InfraredMessage* message = &signal->payload.message;
+    if(!infrared_signal_is_message_valid(message)) {
+        return false;
+    }
+
+    const uint32_t frequency = infrared_get_protocol_frequency(message->protocol);
+    const float duty_cycle = infrared_get_protocol_duty_cycle(message->protocol);
+
+    uint32_t* timings = malloc(sizeof(uint32_t) * MAX_TIMINGS_AMOUNT);
+    bool first_level;
+
+    InfraredEncoderHandler* encoder = infrared_alloc_encoder();
+    infrared_reset_encoder(encoder, message);
+
+    // Same amount of frames infrared_send() would produce for a single transmission.
+    const size_t frames = MAX(infrared_get_protocol_min_repeat_count(message->protocol), 1U);
+    const size_t timings_size =
+        infrared_signal_encode_frames(encoder, frames, true, timings, &first_level);
+
+    if(timings_size) {
+        signal->compiled.timings = malloc(timings_size * sizeof(uint32_t));
+        memcpy(signal->compiled.timings, timings, timings_size * sizeof(uint32_t));
+        signal->compiled.timings_size = timings_size;
+        signal->compiled.frequency = frequency;
+        signal->compiled.duty_cycle = duty_cycle;
+
+        // The frame the encoder produces next is what holding the button sends, e.g. a NEC
+        // repeat code. It is only kept if it can be chained any number of times, i.e.
+        // it continues the alternation of marks and spaces and ends where it started.
+        const size_t repeat_size =
+            infrared_signal_encode_frames(encoder, 1, false, timings, &first_level);
+
+        if(repeat_size && !(repeat_size % 2) && (first_level == !(timings_size % 2))) {
+            signal->compiled_repeat.timings = malloc(repeat_size * sizeof(uint32_t));
+            memcpy(signal->compiled_repeat.timings, timings, repeat_size * sizeof(uint32_t));
+            signal->compiled_repeat.timings_size = repeat_size;
+            signal->compiled_repeat.frequency = frequency;
+            signal->compiled_repeat.duty_cycle = duty_cycle;
+        }
+    }
+
+    infrared_free_encoder(encoder);
+    free(timings);
+
+    return timings_size != 0;
+}
+
+// Test whether encoding a message gives back the raw timings it was decoded from.
+static bool infrared_signal_is_canonical_match(
+    const InfraredMessage* message,
+    size_t frames,
+    const uint32_t* timings,
+    size_t timings_size) {
+    uint32_t* encoded = malloc(sizeof(uint32_t) * MAX_TIMINGS_AMOUNT);
+    bool first_level;
+
+    InfraredEncoderHandler* encoder = infrared_alloc_encoder();
+    infrared_reset_encoder(encoder, message);
+    const size_t encoded_size =
+        infrared_signal_encode_frames(encoder, frames, true, encoded, &first_level);
+    infrared_free_encoder(encoder);
+
+    // The encoder ends with the trailing space of the last frame, recordings don't.
+    bool match = encoded_size && (encoded_size == timings_size ||
+                                  (encoded_size == timings_size + 1 && (timings_size % 2)));
+
+    for(size_t i = 0; match && i < timings_size; ++i) {
+        const uint32_t difference =
+            timings[i] > encoded[i] ? timings[i] - encoded[i] : encoded[i] - timings[i];
+        match = difference * 100 <= encoded[i] * INFRARED_SIGNAL_CANONICAL_TIMING_TOLERANCE;
+    }
+
+    free(encoded);
+    return match;
+}
+
+bool infrared_signal_canonicalize(InfraredSignal* signal) {
+    if(!signal->is_raw) {
+        return true;
+    }
+
+    const InfraredRawSignal* raw = &signal->payload.raw;
+    uint32_t* expanded = signal->compact ? infrared_signal_expand_compact(signal) : NULL;
+    const uint32_t* timings = expanded ? expanded : raw->timings;
+
+    InfraredDecoderHandler* decoder = infrared_alloc_decoder();
+    infrared_reset_decoder(decoder);
+
+    InfraredMessage message;
+    size_t frames = 0;
+    bool clean = true;
+
+    // Every frame must be the same message, or a repeat of it.
+    for(size_t i = 0; clean && i <= raw->timings_size; ++i) {
+        const InfraredMessage* decoded = i < raw->timings_size ?
+                                             infrared_decode(decoder, !(i % 2), timings[i]) :
+                                             infrared_check_decoder_ready(decoder);
+        if(!decoded) {
+            continue;
+        } else if(frames == 0) {
+            message = *decoded;
+            clean = !decoded->repeat;
+        } else if(!decoded->repeat) {
+            clean = decoded->protocol == message.protocol &&
+                    decoded->address == message.address && decoded->command == message.command;
+        }
+        frames++;
+    }
+
+    infrared_free_decoder(decoder);
+
+    // A message is sent as the protocol's minimum amount of frames, so captures of more
+    // frames (e.g. a held button) would be shortened on air and are left raw.
+    if(clean && frames &&
+       frames == MAX(infrared_get_protocol_min_repeat_count(message.protocol), 1U)) {
+        const uint32_t frequency = infrared_get_protocol_frequency(message.protocol);
+        const uint32_t difference = raw->frequency > frequency ? raw->frequency - frequency :
+                                                                 frequency - raw->frequency;
+
+        clean = difference <= INFRARED_SIGNAL_CANONICAL_FREQUENCY_TOLERANCE &&
+                infrared_signal_is_message_valid(&message) &&
+                infrared_signal_is_canonical_match(&message, frames, timings, raw->timings_size);
+    } else {
+        clean = false;
+    }
+
+    free(expanded);
+
+    if(clean) {
+        message.repeat = false;
+        infrared_signal_set_message(signal, &message);
+    }
+
+    return clean;
+}
+
+bool infrared_signal_is_compiled(const InfraredSignal* signal) {
+    return signal->is_raw || signal->compiled.timings;
+}
+
+static const InfraredRawSignal* infrared_signal_get_timings(const InfraredSignal* signal) {
+    if(signal->is_raw) {
+        return &signal->payload.raw;
+    } else if(signal->compiled.timings) {
+        return &signal->compiled;
+    } else {
+        return NULL;
+    }
+}
+
+static void infrared_signal_get_carrier(
+    const InfraredSignal* signal,
+    uint32_t* frequency,
+    float* duty_cycle) {
+    const InfraredRawSignal* timings = infrared_signal_get_timings(signal);
+    if(timings) {
+        *frequency = timings->frequency;
+        *duty_cycle = timings->duty_cycle;
+    } else {
+        *frequency = infrared_get_protocol_frequency(signal->payload.message.protocol);
+        *duty_cycle = infrared_get_protocol_duty_cycle(signal->payload.message.protocol);
+    }
+}
+
+static void infrared_signal_burst_begin_signal(InfraredSignalBurst* burst, size_t signal_index) {
+    const InfraredSignal* signal = burst->signals[signal_index];
+
+    burst->signal_index = signal_index;
+    burst->timing_index = 0;
+    burst->compact_index = 0;
+    burst->repeats_left = 0;
+    burst->in_gap = false;
+
+    if(signal->is_raw) {
+        return;
+    }
+
+    const InfraredMessage* message = &signal->payload.message;
+    const size_t min_frames = MAX(infrared_get_protocol_min_repeat_count(message->protocol), 1U);
+
+    if(signal->compiled.timings) {
+        // Compiled timings already hold the minimum amount of frames.
+        if(burst->times > min_frames && signal->compiled_repeat.timings) {
+            burst->repeats_left = burst->times - min_frames;
+        }
+    } else {
+        infrared_reset_encoder(burst->encoder, message);
+        burst->frames_left = MAX(min_frames, burst->times);
+    }
+}
+
+// Produce the next timing of the burst. Called from the IR transmit interrupt.
+static bool
+    infrared_signal_burst_next(InfraredSignalBurst* burst, uint32_t* duration, bool* level) {
+    while(burst->signal_index < burst->count) {
+        const InfraredSignal* signal = burst->signals[burst->signal_index];
+        const InfraredRawSignal* timings = infrared_signal_get_timings(signal);
+
+        if(burst->in_gap) {
+            const uint32_t gap = burst->gaps[burst->signal_index];
+            infrared_signal_burst_begin_signal(burst, burst->signal_index + 1);
+            if(gap) {
+                *duration = gap;
+                *level = false;
+                return true;
+            }
+            continue;
+        }
+
+        if(timings) {
+            if(burst->timing_index < timings->timings_size) {
+                *level = !(burst->timing_index % 2);
+                *duration = signal->compact ?
+                                infrared_signal_compact_read(signal->compact, &burst->compact_index) :
+                                timings->timings[burst->timing_index];
+                burst->timing_index++;
+                return true;
+            } else if(burst->repeats_left) {
+                // Repeat frames continue the parity of the compiled timings.
+                const InfraredRawSignal* repeat = &signal->compiled_repeat;
+                const size_t repeat_index = burst->timing_index - timings->timings_size;
+                *level = !(burst->timing_index % 2);
+                *duration = repeat->timings[repeat_index];
+                if(repeat_index + 1 == repeat->timings_size) {
+                    burst->timing_index = timings->timings_size;
+                    burst->repeats_left--;
+                } else {
+                    burst->timing_index++;
+                }
+                return true;
+            }
+        } else if(burst->frames_left) {
+            const InfraredStatus status = infrared_encode(burst->encoder, duration, level);
+            if(status == InfraredStatusError) {
+                burst->signal_index = burst->count;
+                burst->failed = true;
+                return false;
+            } else if(status == InfraredStatusDone) {
+                burst->frames_left--;
+            }
+            return true;
+        }
+
+        // The last signal is not followed by a gap.
+        if(burst->signal_index + 1 < burst->count) {
+            burst->in_gap = true;
+        } else {
+            burst->signal_index++;
+        }
+    }
+
+    return false;
+}
+
+static FuriHalInfraredTxGetDataState
+    infrared_signal_burst_callback(void* context, uint32_t* duration, bool* level) {
+    InfraredSignalBurst* burst = context;
+
+    *duration = burst->pending_duration;
+    *level = burst->pending_level;
+
+    uint32_t next_duration;
+    bool next_level;
+
+    while(infrared_signal_burst_next(burst, &next_duration, &next_level)) {
+        if(next_level == *level) {
+            *duration += next_duration;
+        } else {
+            burst->pending_duration = next_duration;
+            burst->pending_level = next_level;
+            return FuriHalInfraredTxGetDataStateOk;
+        }
+    }
+
+    return FuriHalInfraredTxGetDataStateLastDone;
+}
+
 bool infrared_signal_save(const InfraredSignal* signal, FlipperFormat* ff, const char* name) {
     if(!flipper_format_write_comment_cstr(ff, "") ||
        !flipper_format_write_string_cstr(ff, INFRARED_SIGNAL_NAME_KEY, name)) {
         return false;
+    } else if(signal->is_raw && signal->compact) {
+        InfraredRawSignal raw = signal->payload.raw;
+        raw.timings = infrared_signal_expand_compact(signal);
+        const bool success = infrared_signal_save_raw(&raw, ff);
+        free(raw.timings);
+        return success;
     } else if(signal->is_raw) {
         return infrared_signal_save_raw(&signal->payload.raw, ff);
     } else {
@@ -281,6 +899,53 @@ bool infrared_signal_save(const InfraredSignal* signal, FlipperFormat* ff, const
     }
 }
 
+InfraredSignalWriter* infrared_signal_writer_alloc(FlipperFormat* ff) {
+    InfraredSignalWriter* writer = malloc(sizeof(InfraredSignalWriter));
+
+    writer->ff = ff;
+    writer->buffer = flipper_format_string_alloc();
+    writer->chunk = malloc(INFRARED_SIGNAL_WRITER_CHUNK_SIZE);
+
+    return writer;
+}
+
+void infrared_signal_writer_free(InfraredSignalWriter* writer) {
+    flipper_format_free(writer->buffer);
+    free(writer->chunk);
+    free(writer);
+}
+
+bool infrared_signal_writer_flush(InfraredSignalWriter* writer) {
+    Stream* buffer = flipper_format_get_raw_stream(writer->buffer);
+    Stream* stream = flipper_format_get_raw_stream(writer->ff);
+
+    size_t left = stream_size(buffer);
+    bool success = stream_rewind(buffer);
+
+    while(success && left) {
+        const size_t size = MIN(left, (size_t)INFRARED_SIGNAL_WRITER_CHUNK_SIZE);
+        success = stream_read(buffer, writer->chunk, size) == size &&
+                  stream_write(stream, writer->chunk, size) == size;
+        left -= size;
+    }
+
+    stream_clean(buffer);
+    return success;
+}
+
+bool infrared_signal_writer_add(
+    InfraredSignalWriter* writer,
+    const InfraredSignal* signal,
+    const char* name) {
+    if(!infrared_signal_save(signal, writer->buffer, name)) {
+        return false;
+    }
+
+    Stream* buffer = flipper_format_get_raw_stream(writer->buffer);
+    return stream_size(buffer) < INFRARED_SIGNAL_WRITER_CHUNK_SIZE ||
+           infrared_signal_writer_flush(writer);
+}
+
 bool infrared_signal_read(InfraredSignal* signal, FlipperFormat* ff, FuriString* name) {
     bool success = false;
 
@@ -298,44 +963,65 @@ bool infrared_signal_read_name(FlipperFormat* ff, FuriString* name) {
     return flipper_format_read_string(ff, INFRARED_SIGNAL_NAME_KEY, name);
 }
 
-bool infrared_signal_search_by_name_and_read(
+bool infrared_signal_search_by_name_and_read_ctx(
+    InfraredSignalParser* parser,
     InfraredSignal* signal,
     FlipperFormat* ff,
     const char* name) {
     bool success = false;
-    FuriString* tmp = furi_string_alloc();
 
-    while(infrared_signal_read_name(ff, tmp)) {
-        if(furi_string_equal(tmp, name)) {
-            success = infrared_signal_read_body(signal, ff);
+    while(infrared_signal_read_name(ff, parser->name)) {
+        if(furi_string_equal(parser->name, name)) {
+            success = infrared_signal_read_body_ctx(parser, signal, ff);
             break;
         }
     }
 
-    furi_string_free(tmp);
     return success;
 }
 
-bool infrared_signal_search_by_index_and_read(
+bool infrared_signal_search_by_index_and_read_ctx(
+    InfraredSignalParser* parser,
     InfraredSignal* signal,
     FlipperFormat* ff,
     size_t index) {
     bool success = false;
-    FuriString* tmp = furi_string_alloc();
 
-    for(uint32_t i = 0; infrared_signal_read_name(ff, tmp); ++i) {
+    for(uint32_t i = 0; infrared_signal_read_name(ff, parser->name); ++i) {
         if(i == index) {
-            success = infrared_signal_read_body(signal, ff);
+            success = infrared_signal_read_body_ctx(parser, signal, ff);
             break;
         }
     }
 
-    furi_string_free(tmp);
+    return success;
+}
+
+bool infrared_signal_search_by_name_and_read(
+    InfraredSignal* signal,
+    FlipperFormat* ff,
+    const char* name) {
+    InfraredSignalParser* parser = infrared_signal_parser_alloc();
+    const bool success = infrared_signal_search_by_name_and_read_ctx(parser, signal, ff, name);
+    infrared_signal_parser_free(parser);
+    return success;
+}
+
+bool infrared_signal_search_by_index_and_read(
+    InfraredSignal* signal,
+    FlipperFormat* ff,
+    size_t index) {
+    InfraredSignalParser* parser = infrared_signal_parser_alloc();
+    const bool success = infrared_signal_search_by_index_and_read_ctx(parser, signal, ff, index);
+    infrared_signal_parser_free(parser);
     return success;
 }
 
 void infrared_signal_transmit(const InfraredSignal* signal) {
-    if(signal->is_raw) {
+    if(signal->compact) {
+        // Expanded on the fly from the transmit interrupt.
+        infrared_signal_transmit_frames(&signal, NULL, 1, 1);
+    } else if(signal->is_raw) {
         const InfraredRawSignal* raw_signal = &signal->payload.raw;
         infrared_send_raw_ext(
             raw_signal->timings,
@@ -343,8 +1029,579 @@ void infrared_signal_transmit(const InfraredSignal* signal) {
             true,
             raw_signal->frequency,
             raw_signal->duty_cycle);
+    } else if(signal->compiled.timings) {
+        const InfraredRawSignal* compiled = &signal->compiled;
+        infrared_send_raw_ext(
+            compiled->timings,
+            compiled->timings_size,
+            true,
+            compiled->frequency,
+            compiled->duty_cycle);
     } else {
         const InfraredMessage* message = &signal->payload.message;
         infrared_send(message, 1);
     }
 }
+
+uint32_t infrared_signal_hash(const void* data, size_t size) {
+    // 32-bit FNV-1a
+    const uint8_t* bytes = data;
+    uint32_t hash = 2166136261UL;
+
+    for(size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 16777619UL;
+    }
+
+    return hash;
+}
+
+static int infrared_signal_index_compare(const void* a, const void* b) {
+    const InfraredSignalIndexEntry* lhs = a;
+    const InfraredSignalIndexEntry* rhs = b;
+
+    if(lhs->name_hash != rhs->name_hash) {
+        return lhs->name_hash < rhs->name_hash ? -1 : 1;
+    } else if(lhs->position != rhs->position) {
+        return lhs->position < rhs->position ? -1 : 1;
+    } else {
+        return 0;
+    }
+}
+
+InfraredSignalIndex* infrared_signal_index_alloc(void) {
+    InfraredSignalIndex* index = malloc(sizeof(InfraredSignalIndex));
+
+    index->entries = NULL;
+    index->sorted = NULL;
+    index->count = 0;
+
+    return index;
+}
+
+void infrared_signal_index_free(InfraredSignalIndex* index) {
+    free(index->entries);
+    free(index->sorted);
+    free(index);
+}
+
+size_t infrared_signal_index_build(InfraredSignalIndex* index, FlipperFormat* ff) {
+    free(index->entries);
+    free(index->sorted);
+    index->entries = NULL;
+    index->sorted = NULL;
+    index->count = 0;
+
+    Stream* stream = flipper_format_get_raw_stream(ff);
+    FuriString* tmp = furi_string_alloc();
+    size_t capacity = 0;
+
+    for(size_t name_offset = stream_tell(stream); infrared_signal_read_name(ff, tmp);
+        name_offset = stream_tell(stream)) {
+        if(index->count == capacity) {
+            capacity = capacity ? capacity * 2 : 16;
+            index->entries =
+                realloc(index->entries, capacity * sizeof(InfraredSignalIndexEntry));
+        }
+
+        InfraredSignalIndexEntry* entry = &index->entries[index->count];
+        entry->position = index->count++;
+        entry->name_offset = name_offset;
+        entry->name_length = furi_string_size(tmp);
+        entry->name_hash = infrared_signal_hash(furi_string_get_cstr(tmp), entry->name_length);
+        entry->offset = stream_tell(stream);
+    }
+
+    furi_string_free(tmp);
+
+    if(index->count) {
+        const size_t size = index->count * sizeof(InfraredSignalIndexEntry);
+        index->entries = realloc(index->entries, size);
+        index->sorted = malloc(size);
+        memcpy(index->sorted, index->entries, size);
+        qsort(
+            index->sorted,
+            index->count,
+            sizeof(InfraredSignalIndexEntry),
+            infrared_signal_index_compare);
+    }
+
+    return index->count;
+}
+
+size_t infrared_signal_index_get_count(const InfraredSignalIndex* index) {
+    return index->count;
+}
+
+bool infrared_signal_index_search_by_name(
+    const InfraredSignalIndex* index,
+    FlipperFormat* ff,
+    const char* name,
+    size_t* signal_index) {
+    const uint32_t name_length = strlen(name);
+    const uint32_t name_hash = infrared_signal_hash(name, name_length);
+
+    // Lower bound by hash, so that the first signal in the file wins on duplicate names.
+    size_t lo = 0;
+    size_t hi = index->count;
+
+    while(lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if(index->sorted[mid].name_hash < name_hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    // Hashes may collide, so candidates are confirmed by reading their name back.
+    Stream* stream = flipper_format_get_raw_stream(ff);
+    FuriString* tmp = furi_string_alloc();
+    bool found = false;
+
+    for(; lo < index->count && index->sorted[lo].name_hash == name_hash; ++lo) {
+        const InfraredSignalIndexEntry* entry = &index->sorted[lo];
+        if(entry->name_length != name_length) continue;
+
+        if(stream_seek(stream, entry->name_offset, StreamOffsetFromStart) &&
+           infrared_signal_read_name(ff, tmp) && furi_string_equal(tmp, name)) {
+            *signal_index = entry->position;
+            found = true;
+            break;
+        }
+    }
+
+    furi_string_free(tmp);
+    return found;
+}
+
+bool infrared_signal_index_read_by_index(
+    const InfraredSignalIndex* index,
+    InfraredSignal* signal,
+    FlipperFormat* ff,
+    size_t signal_index) {
+    if(signal_index >= index->count) return false;
+
+    Stream* stream = flipper_format_get_raw_stream(ff);
+    if(!stream_seek(stream, index->entries[signal_index].offset, StreamOffsetFromStart)) {
+        return false;
+    }
+
+    return infrared_signal_read_body(signal, ff);
+}
+
+bool infrared_signal_index_read_by_name(
+    const InfraredSignalIndex* index,
+    InfraredSignal* signal,
+    FlipperFormat* ff,
+    const char* name) {
+    size_t signal_index;
+    return infrared_signal_index_search_by_name(index, ff, name, &signal_index) &&
+           infrared_signal_index_read_by_index(index, signal, ff, signal_index);
+}
+
+static uint32_t infrared_signal_message_hash(const InfraredMessage* message) {
+    // Over protocol, address and command
+    const uint32_t words[] = {(uint32_t)message->protocol, message->address, message->command};
+    return infrared_signal_hash(words, sizeof(words));
+}
+
+static inline bool
+    infrared_signal_message_equal(const InfraredMessage* lhs, const InfraredMessage* rhs) {
+    return lhs->protocol == rhs->protocol && lhs->address == rhs->address &&
+           lhs->command == rhs->command;
+}
+
+// Find the slot holding a message, or the empty slot where it would go.
+static size_t infrared_signal_library_find_slot(
+    const InfraredSignalLibrary* library,
+    const InfraredMessage* message) {
+    const size_t mask = library->message_slots_size - 1;
+    size_t slot = infrared_signal_message_hash(message) & mask;
+
+    while(library->message_slots[slot]) {
+        const InfraredSignal* signal = &library->signals[library->message_slots[slot] - 1];
+        if(infrared_signal_message_equal(&signal->payload.message, message)) break;
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+static void infrared_signal_library_build_message_index(InfraredSignalLibrary* library) {
+    free(library->message_slots);
+    library->message_slots = NULL;
+    library->message_slots_size = 0;
+
+    size_t parsed_count = 0;
+    for(size_t i = 0; i < library->count; ++i) {
+        parsed_count += !library->signals[i].is_raw;
+    }
+    if(!parsed_count) return;
+
+    // At most half full, so that probe sequences stay short.
+    size_t slots_size = 4;
+    while(slots_size < parsed_count * 2) {
+        slots_size *= 2;
+    }
+
+    library->message_slots = calloc(slots_size, sizeof(uint32_t));
+    library->message_slots_size = slots_size;
+
+    // Signals are inserted in file order, so the first one of duplicates is kept.
+    for(size_t i = 0; i < library->count; ++i) {
+        const InfraredSignal* signal = &library->signals[i];
+        if(signal->is_raw) continue;
+
+        const size_t slot = infrared_signal_library_find_slot(library, &signal->payload.message);
+        if(!library->message_slots[slot]) {
+            library->message_slots[slot] = i + 1;
+        }
+    }
+}
+
+static void infrared_signal_library_reset(InfraredSignalLibrary* library) {
+    // Only buffers made after loading, e.g. by infrared_signal_compile(), are freed here.
+    for(size_t i = 0; i < library->count; ++i) {
+        infrared_signal_clear_timings(&library->signals[i]);
+    }
+
+    free(library->arena);
+    library->arena = NULL;
+    library->signals = NULL;
+    library->names = NULL;
+    library->count = 0;
+
+    free(library->message_slots);
+    library->message_slots = NULL;
+    library->message_slots_size = 0;
+}
+
+InfraredSignalLibrary* infrared_signal_library_alloc(void) {
+    InfraredSignalLibrary* library = malloc(sizeof(InfraredSignalLibrary));
+
+    library->arena = NULL;
+    library->signals = NULL;
+    library->names = NULL;
+    library->count = 0;
+    library->message_slots = NULL;
+    library->message_slots_size = 0;
+
+    return library;
+}
+
+void infrared_signal_library_free(InfraredSignalLibrary* library) {
+    infrared_signal_library_reset(library);
+    free(library);
+}
+
+bool infrared_signal_library_load(InfraredSignalLibrary* library, FlipperFormat* ff) {
+    infrared_signal_library_reset(library);
+
+    Stream* stream = flipper_format_get_raw_stream(ff);
+    const size_t start = stream_tell(stream);
+    FuriString* tmp = furi_string_alloc();
+
+    size_t count = 0;
+    size_t names_size = 0;
+    size_t timings_size = 0;
+    bool success = true;
+
+    // First pass: only sizes are read, to know how big the arena must be.
+    while(success && infrared_signal_read_name(ff, tmp)) {
+        count++;
+        names_size += furi_string_size(tmp) + 1;
+
+        InfraredRawSignal raw;
+        success = flipper_format_read_string(ff, INFRARED_SIGNAL_TYPE_KEY, tmp) &&
+                  (!furi_string_equal(tmp, INFRARED_SIGNAL_TYPE_RAW) ||
+                   infrared_signal_read_raw_header(&raw, ff));
+        if(success && furi_string_equal(tmp, INFRARED_SIGNAL_TYPE_RAW)) {
+            timings_size += raw.timings_size;
+        }
+    }
+
+    // Second pass: signals are read straight into the arena.
+    if(success && count) {
+        const size_t names_offset = count * sizeof(InfraredSignal);
+        const size_t timings_offset = names_offset + count * sizeof(const char*);
+        const size_t chars_offset = timings_offset + timings_size * sizeof(uint32_t);
+
+        uint8_t* arena = malloc(chars_offset + names_size);
+        uint32_t* timings = (uint32_t*)(arena + timings_offset);
+        char* chars = (char*)(arena + chars_offset);
+
+        library->arena = arena;
+        library->signals = (InfraredSignal*)arena;
+        library->names = (const char**)(arena + names_offset);
+        library->count = count;
+
+        for(size_t i = 0; i < count; ++i) {
+            infrared_signal_init(&library->signals[i]);
+            library->names[i] = "";
+        }
+
+        success = stream_seek(stream, start, StreamOffsetFromStart);
+
+        for(size_t i = 0; success && i < count; ++i) {
+            InfraredSignal* signal = &library->signals[i];
+            success = false;
+
+            do {
+                if(!infrared_signal_read_name(ff, tmp)) break;
+
+                // Sizes are checked again in case the file has changed in between.
+                const size_t name_size = furi_string_size(tmp) + 1;
+                if(name_size > names_size) break;
+
+                memcpy(chars, furi_string_get_cstr(tmp), name_size);
+                library->names[i] = chars;
+                chars += name_size;
+                names_size -= name_size;
+
+                if(!flipper_format_read_string(ff, INFRARED_SIGNAL_TYPE_KEY, tmp)) break;
+
+                if(furi_string_equal(tmp, INFRARED_SIGNAL_TYPE_RAW)) {
+                    InfraredRawSignal raw;
+                    if(!infrared_signal_read_raw_header(&raw, ff)) break;
+                    if(raw.timings_size > timings_size) break;
+                    if(!flipper_format_read_uint32(
+                           ff, INFRARED_SIGNAL_DATA_KEY, timings, raw.timings_size)) {
+                        break;
+                    }
+
+                    infrared_signal_set_raw_signal_static(
+                        signal, timings, raw.timings_size, raw.frequency, raw.duty_cycle);
+                    timings += raw.timings_size;
+                    timings_size -= raw.timings_size;
+                } else if(furi_string_equal(tmp, INFRARED_SIGNAL_TYPE_PARSED)) {
+                    if(!infrared_signal_read_message(signal, ff, tmp)) break;
+                } else {
+                    FURI_LOG_E(TAG, "Unknown signal type: %s", furi_string_get_cstr(tmp));
+                    break;
+                }
+
+                success = true;
+            } while(false);
+        }
+    }
+
+    furi_string_free(tmp);
+
+    if(success) {
+        infrared_signal_library_build_message_index(library);
+    } else {
+        infrared_signal_library_reset(library);
+    }
+
+    return success;
+}
+
+size_t infrared_signal_library_get_count(const InfraredSignalLibrary* library) {
+    return library->count;
+}
+
+const char* infrared_signal_library_get_name(const InfraredSignalLibrary* library, size_t index) {
+    furi_assert(index < library->count);
+    return library->names[index];
+}
+
+InfraredSignal* infrared_signal_library_get_signal(InfraredSignalLibrary* library, size_t index) {
+    furi_assert(index < library->count);
+    return &library->signals[index];
+}
+
+size_t infrared_signal_library_canonicalize(InfraredSignalLibrary* library) {
+    size_t converted = 0;
+
+    for(size_t i = 0; i < library->count; ++i) {
+        InfraredSignal* signal = &library->signals[i];
+        if(signal->is_raw && infrared_signal_canonicalize(signal)) {
+            converted++;
+        }
+    }
+
+    if(converted) {
+        infrared_signal_library_build_message_index(library);
+    }
+
+    return converted;
+}
+
+bool infrared_signal_library_validate(
+    const InfraredSignalLibrary* library,
+    size_t* invalid_index) {
+    for(size_t i = 0; i < library->count; ++i) {
+        if(!infrared_signal_is_valid(&library->signals[i])) {
+            if(invalid_index) {
+                *invalid_index = i;
+            }
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool infrared_signal_library_search_by_name(
+    const InfraredSignalLibrary* library,
+    const char* name,
+    size_t* index) {
+    for(size_t i = 0; i < library->count; ++i) {
+        if(strcmp(library->names[i], name) == 0) {
+            *index = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool infrared_signal_library_save(const InfraredSignalLibrary* library, FlipperFormat* ff) {
+    InfraredSignalWriter* writer = infrared_signal_writer_alloc(ff);
+    bool success = true;
+
+    for(size_t i = 0; success && i < library->count; ++i) {
+        success = infrared_signal_writer_add(writer, &library->signals[i], library->names[i]);
+    }
+
+    success = infrared_signal_writer_flush(writer) && success;
+    infrared_signal_writer_free(writer);
+
+    return success;
+}
+
+bool infrared_signal_library_search_by_message(
+    const InfraredSignalLibrary* library,
+    const InfraredMessage* message,
+    size_t* index) {
+    if(!library->message_slots_size) return false;
+
+    const size_t slot = infrared_signal_library_find_slot(library, message);
+    if(!library->message_slots[slot]) return false;
+
+    *index = library->message_slots[slot] - 1;
+    return true;
+}
+
+size_t infrared_signal_library_dedupe(InfraredSignalLibrary* library) {
+    if(!library->message_slots_size) return 0;
+
+    // Signals are moved below, so duplicates are all found beforehand.
+    bool* duplicate = malloc(library->count * sizeof(bool));
+    for(size_t i = 0; i < library->count; ++i) {
+        size_t first;
+        duplicate[i] = !library->signals[i].is_raw &&
+                       infrared_signal_library_search_by_message(
+                           library, &library->signals[i].payload.message, &first) &&
+                       first != i;
+    }
+
+    size_t kept = 0;
+    for(size_t i = 0; i < library->count; ++i) {
+        if(duplicate[i]) {
+            infrared_signal_clear_timings(&library->signals[i]);
+        } else {
+            library->signals[kept] = library->signals[i];
+            library->names[kept] = library->names[i];
+            kept++;
+        }
+    }
+
+    free(duplicate);
+
+    const size_t removed = library->count - kept;
+    library->count = kept;
+
+    if(removed) {
+        infrared_signal_library_build_message_index(library);
+    }
+
+    return removed;
+}
+
+static bool infrared_signal_transmit_frames(
+    const InfraredSignal* const* signals,
+    const uint32_t* gaps,
+    size_t count,
+    size_t times) {
+    furi_assert(count == 0 || signals);
+    furi_assert(count < 2 || gaps);
+
+    if(count == 0) {
+        return true;
+    } else if(furi_hal_infrared_is_busy()) {
+        // E.g. the receiver is running, the HAL can't do both at once.
+        FURI_LOG_E(TAG, "Infrared hardware is busy");
+        return false;
+    }
+
+    uint32_t frequency;
+    float duty_cycle;
+    infrared_signal_get_carrier(signals[0], &frequency, &duty_cycle);
+
+    bool needs_encoder = false;
+    for(size_t i = 0; i < count; ++i) {
+        uint32_t signal_frequency;
+        float signal_duty_cycle;
+        infrared_signal_get_carrier(signals[i], &signal_frequency, &signal_duty_cycle);
+
+        if(signal_frequency != frequency || signal_duty_cycle != duty_cycle) {
+            FURI_LOG_E(TAG, "Burst signals must share the same carrier");
+            return false;
+        }
+
+        needs_encoder |= !infrared_signal_get_timings(signals[i]);
+    }
+
+    InfraredSignalBurst burst = {
+        .signals = signals,
+        .gaps = gaps,
+        .count = count,
+        .times = times,
+        .encoder = needs_encoder ? infrared_alloc_encoder() : NULL,
+    };
+
+    infrared_signal_burst_begin_signal(&burst, 0);
+
+    const bool has_timings =
+        infrared_signal_burst_next(&burst, &burst.pending_duration, &burst.pending_level);
+
+    if(has_timings) {
+        furi_hal_infrared_async_tx_set_data_isr_callback(infrared_signal_burst_callback, &burst);
+        furi_hal_infrared_async_tx_start(frequency, duty_cycle);
+        furi_hal_infrared_async_tx_wait_termination();
+    }
+
+    if(burst.encoder) {
+        infrared_free_encoder(burst.encoder);
+    }
+
+    return has_timings && !burst.failed;
+}
+
+bool infrared_signal_transmit_burst(
+    const InfraredSignal* const* signals,
+    const uint32_t* gaps,
+    size_t count) {
+    return infrared_signal_transmit_frames(signals, gaps, count, 1);
+}
+
+void infrared_signal_transmit_times(const InfraredSignal* signal, size_t times) {
+    furi_assert(times > 0);
+
+    if(signal->is_raw) {
+        // Raw signals have no notion of repeat frames, the whole signal is sent again,
+        // with some silence in between so that receivers see separate frames.
+        for(size_t i = 0; i < times; ++i) {
+            if(i > 0) {
+                furi_delay_ms(INFRARED_SIGNAL_RAW_REPEAT_DELAY_MS);
+            }
+            infrared_signal_transmit(signal);
+        }
+    } else if(signal->compiled.timings && times > 1 && !signal->compiled_repeat.timings) {
+        infrared_send(&signal->payload.message, times);
+    } else {
+        infrared_signal_transmit_frames(&signal, NULL, 1, times);
+    }
+}
@@ -16,6 +16,26 @@
  */
 typedef struct InfraredSignal InfraredSignal;
 
+/**
+ * @brief InfraredSignalIndex opaque type declaration.
+ */
+typedef struct InfraredSignalIndex InfraredSignalIndex;
+
+/**
+ * @brief InfraredSignalLibrary opaque type declaration.
+ */
+typedef struct InfraredSignalLibrary InfraredSignalLibrary;
+
+/**
+ * @brief InfraredSignalParser opaque type declaration.
+ */
+typedef struct InfraredSignalParser InfraredSignalParser;
+
+/**
+ * @brief InfraredSignalWriter opaque type declaration.
+ */
+typedef struct InfraredSignalWriter InfraredSignalWriter;
+
 /**
  * @brief Raw signal type definition.
  *
@@ -93,16 +113,98 @@ void infrared_signal_set_raw_signal(
     uint32_t frequency,
     float duty_cycle);
 
+/**
+ * @brief Set an InfraredInstance to hold a raw signal, taking ownership of its timings.
+ *
+ * Same as infrared_signal_set_raw_signal(), but the timings array is not copied.
+ * Instead, the instance takes it over and frees it along with its other contents,
+ * so that each raw signal only has to be allocated once.
+ *
+ * @param[in,out] signal pointer to the destination instance.
+ * @param[in] timings pointer to a heap-allocated array of timings to be taken over.
+ * @param[in] timings_size number of elements in the timings array.
+ * @param[in] frequency signal carrier frequency, in Hertz.
+ * @param[in] duty_cycle signal duty cycle, fraction between 0 and 1.
+ */
+void infrared_signal_adopt_raw_signal(
+    InfraredSignal* signal,
+    uint32_t* timings,
+    size_t timings_size,
+    uint32_t frequency,
+    float duty_cycle);
+
+/**
+ * @brief Set an InfraredInstance to hold a raw signal with constant timings.
+ *
+ * Same as infrared_signal_set_raw_signal(), but the timings array is neither copied
+ * nor ever freed, so signals known at build time cost no RAM for their timings.
+ * The array must outlive the instance (e.g. a static const array placed in flash).
+ *
+ * @param[in,out] signal pointer to the destination instance.
+ * @param[in] timings pointer to a constant array containing the raw signal timings.
+ * @param[in] timings_size number of elements in the timings array.
+ * @param[in] frequency signal carrier frequency, in Hertz.
+ * @param[in] duty_cycle signal duty cycle, fraction between 0 and 1.
+ */
+void infrared_signal_set_raw_signal_static(
+    InfraredSignal* signal,
+    const uint32_t* timings,
+    size_t timings_size,
+    uint32_t frequency,
+    float duty_cycle);
+
+/**
+ * @brief Test whether an InfraredSignal instance holds a raw signal with constant timings.
+ *
+ * @param[in] signal pointer to the instance to be tested.
+ * @returns true if the timings were set with infrared_signal_set_raw_signal_static().
+ */
+bool infrared_signal_is_static(const InfraredSignal* signal);
+
 /**
  * @brief Get the raw signal held by an InfraredSignal instance.
  *
  * @warning the instance MUST hold a *raw* signal, otherwise undefined behaviour will occur.
+ * @warning the signal MUST NOT be compact, or the system will crash (in release builds too).
+ * Compact signals have no timings array, call infrared_signal_expand() first.
  *
  * @param[in] signal pointer to the instance to be queried.
  * @returns pointer to the raw signal structure held by the instance.
  */
 const InfraredRawSignal* infrared_signal_get_raw_signal(const InfraredSignal* signal);
 
+/**
+ * @brief Convert the raw timings held by an InfraredSignal instance to a compact form.
+ *
+ * Timings are stored as 16-bit values, with an escape code for the rare ones that
+ * don't fit, which halves the memory taken by most raw signals. They are expanded
+ * on the fly during transmission.
+ *
+ * Parsed signals and constant timings are left as they are, as well as signals that
+ * would not get any smaller.
+ *
+ * @param[in,out] signal pointer to the instance to be converted.
+ * @returns true if the instance holds compact timings after this call, false otherwise.
+ */
+bool infrared_signal_compact(InfraredSignal* signal);
+
+/**
+ * @brief Test whether an InfraredSignal instance holds compact raw timings.
+ *
+ * @param[in] signal pointer to the instance to be tested.
+ * @returns true if the instance holds compact timings, false otherwise.
+ */
+bool infrared_signal_is_compact(const InfraredSignal* signal);
+
+/**
+ * @brief Convert compact raw timings back to the regular form.
+ *
+ * Has no effect if the instance does not hold compact timings.
+ *
+ * @param[in,out] signal pointer to the instance to be converted.
+ */
+void infrared_signal_expand(InfraredSignal* signal);
+
 /**
  * @brief Set an InfraredInstance to hold a parsed signal.
  *
@@ -126,6 +228,45 @@ void infrared_signal_set_message(InfraredSignal* signal, const InfraredMessage*
  */
 const InfraredMessage* infrared_signal_get_message(const InfraredSignal* signal);
 
+/**
+ * @brief Pre-encode the parsed signal held by an InfraredSignal instance.
+ *
+ * The message is run through its protocol encoder once and the resulting timings are
+ * cached in the instance, so that infrared_signal_transmit() can send them directly
+ * instead of encoding the message again on every call. The protocol repeat frame, if
+ * any, is cached as well for infrared_signal_transmit_times().
+ *
+ * The cached timings are discarded whenever the instance is assigned a new signal.
+ * Raw signals need no compilation, calling this function on them has no effect.
+ *
+ * @param[in,out] signal pointer to the instance to be compiled.
+ * @returns true if the signal was successfully compiled, false otherwise (e.g. encoder error).
+ */
+bool infrared_signal_compile(InfraredSignal* signal);
+
+/**
+ * @brief Convert the raw signal held by an InfraredSignal instance to a parsed one, if possible.
+ *
+ * The raw timings are run through the infrared decoder. If every frame decodes to the
+ * same message (or its repeat), there are as many frames as a single transmission of the
+ * message has (the protocol's minimum repeat count), the carrier frequency is that of the
+ * protocol and encoding the message gives back the same timings within tolerance, the
+ * instance is made to hold the message instead, which takes less memory and transmits
+ * the same.
+ *
+ * @param[in,out] signal pointer to the instance to be converted.
+ * @returns true if the instance holds a parsed signal after this call, false otherwise.
+ */
+bool infrared_signal_canonicalize(InfraredSignal* signal);
+
+/**
+ * @brief Test whether an InfraredSignal instance can be transmitted without encoding.
+ *
+ * @param[in] signal pointer to the instance to be tested.
+ * @returns true if the instance holds a raw or a compiled parsed signal, false otherwise.
+ */
+bool infrared_signal_is_compiled(const InfraredSignal* signal);
+
 /**
  * @brief Read a signal and its name from a FlipperFormat file into an InfraredSignal instance.
  *
@@ -194,6 +335,67 @@ bool infrared_signal_search_by_index_and_read(
     FlipperFormat* ff,
     size_t index);
 
+/**
+ * @brief Create a new InfraredSignalParser instance.
+ *
+ * A parser holds the scratch strings used when reading signals, so that the _ctx
+ * variants of the read functions don't allocate anything but the signals themselves.
+ * It may be reused for any number of calls and files, but not from several threads at once.
+ *
+ * @returns pointer to the instance created.
+ */
+InfraredSignalParser* infrared_signal_parser_alloc(void);
+
+/**
+ * @brief Delete an InfraredSignalParser instance.
+ *
+ * @param[in,out] parser pointer to the instance to be deleted.
+ */
+void infrared_signal_parser_free(InfraredSignalParser* parser);
+
+/**
+ * @brief Same as infrared_signal_read_body(), using the scratch strings of a parser.
+ *
+ * @param[in,out] parser pointer to the parser instance to be used.
+ * @param[in,out] signal pointer to the instance to be read into.
+ * @param[in,out] ff pointer to the FlipperFormat file instance to read from.
+ * @returns true if a signal body was successfully read, false otherwise (e.g. syntax error).
+ */
+bool infrared_signal_read_body_ctx(
+    InfraredSignalParser* parser,
+    InfraredSignal* signal,
+    FlipperFormat* ff);
+
+/**
+ * @brief Same as infrared_signal_search_by_name_and_read(), using the scratch strings of a parser.
+ *
+ * @param[in,out] parser pointer to the parser instance to be used.
+ * @param[in,out] signal pointer to the instance to be read into.
+ * @param[in,out] ff pointer to the FlipperFormat file instance to read from.
+ * @param[in] name pointer to a zero-terminated string containing the requested signal name.
+ * @returns true if a signal was found and successfully read, false otherwise (e.g. the signal was not found).
+ */
+bool infrared_signal_search_by_name_and_read_ctx(
+    InfraredSignalParser* parser,
+    InfraredSignal* signal,
+    FlipperFormat* ff,
+    const char* name);
+
+/**
+ * @brief Same as infrared_signal_search_by_index_and_read(), using the scratch strings of a parser.
+ *
+ * @param[in,out] parser pointer to the parser instance to be used.
+ * @param[in,out] signal pointer to the instance to be read into.
+ * @param[in,out] ff pointer to the FlipperFormat file instance to read from.
+ * @param[in] index the requested signal index.
+ * @returns true if a signal was found and successfully read, false otherwise (e.g. the signal was not found).
+ */
+bool infrared_signal_search_by_index_and_read_ctx(
+    InfraredSignalParser* parser,
+    InfraredSignal* signal,
+    FlipperFormat* ff,
+    size_t index);
+
 /**
  * @brief Save a signal contained in an InfraredSignal instance to a FlipperFormat file.
  *
@@ -206,11 +408,345 @@ bool infrared_signal_search_by_index_and_read(
  */
 bool infrared_signal_save(const InfraredSignal* signal, FlipperFormat* ff, const char* name);
 
+/**
+ * @brief Create a new InfraredSignalWriter instance.
+ *
+ * A signal writer saves any number of signals to a FlipperFormat file like
+ * infrared_signal_save() does, but serializes them in memory first and writes them
+ * out in large chunks rather than one key at a time.
+ *
+ * The file must be allocated and open prior to this call, with an appropriate header
+ * already written. It must not be written to by other means until the writer is flushed.
+ *
+ * @param[in,out] ff pointer to the FlipperFormat file instance to write to.
+ * @returns pointer to the instance created.
+ */
+InfraredSignalWriter* infrared_signal_writer_alloc(FlipperFormat* ff);
+
+/**
+ * @brief Delete an InfraredSignalWriter instance.
+ *
+ * Signals not yet flushed are discarded.
+ *
+ * @param[in,out] writer pointer to the instance to be deleted.
+ */
+void infrared_signal_writer_free(InfraredSignalWriter* writer);
+
+/**
+ * @brief Add a signal to be saved by an InfraredSignalWriter instance.
+ *
+ * The file is written to whenever enough signals have been added.
+ *
+ * @param[in,out] writer pointer to the instance to be used.
+ * @param[in] signal pointer to the instance holding the signal to be saved.
+ * @param[in] name pointer to a zero-terminated string contating the name of the signal.
+ * @returns true if the signal was successfully added, false otherwise (e.g. write error).
+ */
+bool infrared_signal_writer_add(
+    InfraredSignalWriter* writer,
+    const InfraredSignal* signal,
+    const char* name);
+
+/**
+ * @brief Write all signals added to an InfraredSignalWriter instance out to the file.
+ *
+ * @param[in,out] writer pointer to the instance to be flushed.
+ * @returns true if all signals were successfully written, false otherwise.
+ */
+bool infrared_signal_writer_flush(InfraredSignalWriter* writer);
+
 /**
  * @brief Transmit a signal contained in an InfraredSignal instance.
  *
  * The transmission happens once per call using the built-in hardware (via HAL calls).
+ * Compiled parsed signals are sent from their cached timings, see infrared_signal_compile().
  *
  * @param[in] signal pointer to the instance holding the signal to be transmitted.
  */
 void infrared_signal_transmit(const InfraredSignal* signal);
+
+/**
+ * @brief Transmit a signal as if its button was held.
+ *
+ * Parsed signals are sent once followed by protocol repeat frames (e.g. NEC repeat
+ * codes), for a total of times frames, which is much shorter on air than sending
+ * the full frame again. Raw signals are sent times times in full, 150 ms apart.
+ *
+ * @param[in] signal pointer to the instance holding the signal to be transmitted.
+ * @param[in] times number of frames to be sent, at least 1.
+ */
+void infrared_signal_transmit_times(const InfraredSignal* signal, size_t times);
+
+/**
+ * @brief Transmit several signals back to back in a single transmission.
+ *
+ * The signals are sent within one HAL transmit session, with the given amount of
+ * silence between consecutive ones, so that no time is lost setting up the hardware
+ * for each of them. Compiled and raw signals are sent from their timings, parsed
+ * signals are encoded on the fly.
+ *
+ * All signals must use the same carrier frequency and duty cycle.
+ *
+ * @param[in] signals pointer to an array of signals to be transmitted.
+ * @param[in] gaps pointer to an array of count - 1 gaps between the signals, in microseconds.
+ * @param[in] count number of elements in the signals array.
+ * @returns true if all signals were transmitted, false otherwise (e.g. carriers differ or
+ *          the infrared hardware is busy receiving).
+ */
+bool infrared_signal_transmit_burst(
+    const InfraredSignal* const* signals,
+    const uint32_t* gaps,
+    size_t count);
+
+/**
+ * @brief Compute the 32-bit FNV-1a hash of a block of memory.
+ *
+ * Used for signal names in indexes and caches, so that hashes computed by different
+ * modules, including those stored in files, always agree.
+ *
+ * @param[in] data pointer to the memory to be hashed.
+ * @param[in] size number of bytes to be hashed.
+ * @returns hash value.
+ */
+uint32_t infrared_signal_hash(const void* data, size_t size);
+
+/**
+ * @brief Create a new InfraredSignalIndex instance.
+ *
+ * A signal index remembers where each signal in a FlipperFormat file starts, so that
+ * looking a signal up by name or by index takes a single seek and body read instead of
+ * scanning the file from the current position.
+ *
+ * @returns pointer to the instance created.
+ */
+InfraredSignalIndex* infrared_signal_index_alloc(void);
+
+/**
+ * @brief Delete an InfraredSignalIndex instance.
+ *
+ * @param[in,out] index pointer to the instance to be deleted.
+ */
+void infrared_signal_index_free(InfraredSignalIndex* index);
+
+/**
+ * @brief Index all signals in a FlipperFormat file.
+ *
+ * The file must be allocated and open prior to this call. Signals are indexed from the
+ * current seek position to the end of the file in one pass, reading only their names.
+ * Any previous contents of the index are discarded.
+ *
+ * The index remains valid for as long as the file is not modified.
+ *
+ * @param[in,out] index pointer to the instance to be built.
+ * @param[in,out] ff pointer to the FlipperFormat file instance to read from.
+ * @returns number of signals indexed.
+ */
+size_t infrared_signal_index_build(InfraredSignalIndex* index, FlipperFormat* ff);
+
+/**
+ * @brief Get the number of signals in an InfraredSignalIndex instance.
+ *
+ * @param[in] index pointer to the instance to be queried.
+ * @returns number of signals indexed.
+ */
+size_t infrared_signal_index_get_count(const InfraredSignalIndex* index);
+
+/**
+ * @brief Find the index of a signal with a particular name.
+ *
+ * Candidates are looked up by name hash, and their names are read back from the file
+ * to confirm the match. If several signals share the same name, the first one in the
+ * file is reported. The file must be the same one the index was built from, and its
+ * seek position is changed.
+ *
+ * @param[in] index pointer to the instance to be queried.
+ * @param[in,out] ff pointer to the FlipperFormat file instance to read names from.
+ * @param[in] name pointer to a zero-terminated string containing the requested signal name.
+ * @param[out] signal_index pointer to the variable to hold the signal index.
+ * @returns true if the signal was found, false otherwise.
+ */
+bool infrared_signal_index_search_by_name(
+    const InfraredSignalIndex* index,
+    FlipperFormat* ff,
+    const char* name,
+    size_t* signal_index);
+
+/**
+ * @brief Read a signal with a particular index using an InfraredSignalIndex instance.
+ *
+ * Same as infrared_signal_search_by_index_and_read(), but the file is not scanned.
+ * The file must be the same one the index was built from.
+ *
+ * @param[in] index pointer to the instance to be used.
+ * @param[in,out] signal pointer to the instance to be read into.
+ * @param[in,out] ff pointer to the FlipperFormat file instance to read from.
+ * @param[in] signal_index the requested signal index.
+ * @returns true if a signal was found and successfully read, false otherwise.
+ */
+bool infrared_signal_index_read_by_index(
+    const InfraredSignalIndex* index,
+    InfraredSignal* signal,
+    FlipperFormat* ff,
+    size_t signal_index);
+
+/**
+ * @brief Read a signal with a particular name using an InfraredSignalIndex instance.
+ *
+ * Same as infrared_signal_search_by_name_and_read(), but the file is not scanned.
+ * The file must be the same one the index was built from.
+ *
+ * @param[in] index pointer to the instance to be used.
+ * @param[in,out] signal pointer to the instance to be read into.
+ * @param[in,out] ff pointer to the FlipperFormat file instance to read from.
+ * @param[in] name pointer to a zero-terminated string containing the requested signal name.
+ * @returns true if a signal was found and successfully read, false otherwise.
+ */
+bool infrared_signal_index_read_by_name(
+    const InfraredSignalIndex* index,
+    InfraredSignal* signal,
+    FlipperFormat* ff,
+    const char* name);
+
+/**
+ * @brief Create a new InfraredSignalLibrary instance.
+ *
+ * A signal library holds all signals of a FlipperFormat file at once. The signals,
+ * their names and raw timings are kept in a single allocation, which is made and
+ * released in one go rather than signal by signal.
+ *
+ * @returns pointer to the instance created.
+ */
+InfraredSignalLibrary* infrared_signal_library_alloc(void);
+
+/**
+ * @brief Delete an InfraredSignalLibrary instance along with all signals it holds.
+ *
+ * @param[in,out] library pointer to the instance to be deleted.
+ */
+void infrared_signal_library_free(InfraredSignalLibrary* library);
+
+/**
+ * @brief Load all signals in a FlipperFormat file.
+ *
+ * The file must be allocated and open prior to this call. Signals are loaded from the
+ * current seek position to the end of the file in two passes: the first one only
+ * measures them, the second one reads them into place. Any previous contents of the
+ * library are discarded, including on failure.
+ *
+ * @param[in,out] library pointer to the instance to be loaded.
+ * @param[in,out] ff pointer to the FlipperFormat file instance to read from.
+ * @returns true if all signals were successfully loaded, false otherwise.
+ */
+bool infrared_signal_library_load(InfraredSignalLibrary* library, FlipperFormat* ff);
+
+/**
+ * @brief Get the number of signals in an InfraredSignalLibrary instance.
+ *
+ * @param[in] library pointer to the instance to be queried.
+ * @returns number of signals loaded.
+ */
+size_t infrared_signal_library_get_count(const InfraredSignalLibrary* library);
+
+/**
+ * @brief Get the name of a signal in an InfraredSignalLibrary instance.
+ *
+ * @param[in] library pointer to the instance to be queried.
+ * @param[in] index index of the signal, must be less than the number of signals.
+ * @returns pointer to a zero-terminated string owned by the library.
+ */
+const char* infrared_signal_library_get_name(const InfraredSignalLibrary* library, size_t index);
+
+/**
+ * @brief Get a signal held by an InfraredSignalLibrary instance.
+ *
+ * The signal is owned by the library and MUST NOT be passed to infrared_signal_free().
+ * Raw signals hold constant timings, see infrared_signal_set_raw_signal_static(), so
+ * copies made with infrared_signal_set_signal() are only valid as long as the library.
+ *
+ * @param[in] library pointer to the instance to be queried.
+ * @param[in] index index of the signal, must be less than the number of signals.
+ * @returns pointer to the signal.
+ */
+InfraredSignal* infrared_signal_library_get_signal(InfraredSignalLibrary* library, size_t index);
+
+/**
+ * @brief Convert all raw signals held by an InfraredSignalLibrary instance to parsed ones, where possible.
+ *
+ * See infrared_signal_canonicalize(). The memory of converted raw timings is released
+ * with the rest of the library.
+ *
+ * @param[in,out] library pointer to the instance to be converted.
+ * @returns number of signals converted.
+ */
+size_t infrared_signal_library_canonicalize(InfraredSignalLibrary* library);
+
+/**
+ * @brief Validate all signals held by an InfraredSignalLibrary instance.
+ *
+ * Same checks as infrared_signal_is_valid(), stopping at the first invalid signal.
+ *
+ * @param[in] library pointer to the instance to be validated.
+ * @param[out] invalid_index pointer to the variable to hold the index of the first
+ *             invalid signal, may be NULL.
+ * @returns true if all signals are valid, false otherwise.
+ */
+bool infrared_signal_library_validate(
+    const InfraredSignalLibrary* library,
+    size_t* invalid_index);
+
+/**
+ * @brief Find the index of a signal with a particular name.
+ *
+ * If several signals share the same name, the first one in the file is reported.
+ *
+ * @param[in] library pointer to the instance to be queried.
+ * @param[in] name pointer to a zero-terminated string containing the requested signal name.
+ * @param[out] index pointer to the variable to hold the signal index.
+ * @returns true if the signal was found, false otherwise.
+ */
+bool infrared_signal_library_search_by_name(
+    const InfraredSignalLibrary* library,
+    const char* name,
+    size_t* index);
+
+/**
+ * @brief Save all signals held by an InfraredSignalLibrary instance to a FlipperFormat file.
+ *
+ * Signals are written through an InfraredSignalWriter, see infrared_signal_writer_alloc().
+ *
+ * @param[in] library pointer to the instance to be saved.
+ * @param[in,out] ff pointer to the FlipperFormat file instance to write to.
+ * @returns true if all signals were successfully saved, false otherwise.
+ */
+bool infrared_signal_library_save(const InfraredSignalLibrary* library, FlipperFormat* ff);
+
+/**
+ * @brief Find the index of a parsed signal with a particular message.
+ *
+ * Messages are looked up in a hash index over their protocol, address and command,
+ * built when the library is loaded (and again when it is canonicalized or deduplicated),
+ * so the cost does not depend on the number of signals. The repeat flag is ignored.
+ * If several signals share the same message, the first one in the file is reported.
+ *
+ * Changes made to signals through infrared_signal_library_get_signal() are not indexed.
+ *
+ * @param[in] library pointer to the instance to be queried.
+ * @param[in] message pointer to the message to be looked up.
+ * @param[out] index pointer to the variable to hold the signal index.
+ * @returns true if a signal was found, false otherwise.
+ */
+bool infrared_signal_library_search_by_message(
+    const InfraredSignalLibrary* library,
+    const InfraredMessage* message,
+    size_t* index);
+
+/**
+ * @brief Remove parsed signals whose message is already held by an earlier signal.
+ *
+ * The first signal of each message is kept along with its name, later ones are removed
+ * and signals after them move down, which changes their indices. Raw signals are kept.
+ *
+ * @param[in,out] library pointer to the instance to be deduplicated.
+ * @returns number of signals removed.
+ */
+size_t infrared_signal_library_dedupe(InfraredSignalLibrary* library);